@@ -0,0 +1,129 @@
+// main.cpp
+// 比较三种时间戳时钟（precise / coarse / tsc）：
+//   1. 单次取时间的耗时
+//   2. 与系统时钟的偏差和可见分辨率
+//   3. 使用该时钟的 logger 写入 null_sink 的单条日志耗时
+//
+// 用法: clock_bench [-n iterations]
+#include <spdlog/details/clock.h>
+#include <spdlog/logger.h>
+#include <spdlog/sinks/null_sink.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+
+using bench_clock = std::chrono::steady_clock;
+
+static const char *source_name(spdlog::clock_source source)
+{
+    switch (source) {
+        case spdlog::clock_source::coarse:
+            return "coarse";
+        case spdlog::clock_source::tsc:
+            return "tsc";
+        default:
+            return "precise";
+    }
+}
+
+static long long ns_between(bench_clock::time_point start, bench_clock::time_point end)
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+}
+
+// 单次调用 clock_now 的平均耗时 (ns)
+static double time_clock(spdlog::clock_source source, size_t iterations)
+{
+    long long sink = 0;
+    auto start = bench_clock::now();
+    for (size_t i = 0; i < iterations; i++) {
+        sink += spdlog::details::clock_now(source).time_since_epoch().count();
+    }
+    auto end = bench_clock::now();
+    // 防止循环被优化掉
+    if (sink == 42) {
+        std::puts("");
+    }
+    return static_cast<double>(ns_between(start, end)) / static_cast<double>(iterations);
+}
+
+// 与 log_clock 的最大偏差 (us)，以及相邻两次读数的最小非零间隔 (ns)
+static void measure_accuracy(spdlog::clock_source source, double &max_skew_us, long long &resolution_ns)
+{
+    max_skew_us = 0;
+    resolution_ns = 0;
+    auto prev = spdlog::details::clock_now(source);
+    for (int i = 0; i < 100000; i++) {
+        auto before = spdlog::log_clock::now();
+        auto t = spdlog::details::clock_now(source);
+        auto after = spdlog::log_clock::now();
+
+        // 不在 [before, after] 区间内的部分记为偏差
+        auto skew = t < before ? before - t : (t > after ? t - after : spdlog::log_clock::duration::zero());
+        auto skew_us = std::chrono::duration<double, std::micro>(skew).count();
+        max_skew_us = std::max(max_skew_us, skew_us);
+
+        auto step = std::chrono::duration_cast<std::chrono::nanoseconds>(t - prev).count();
+        if (step > 0 && (resolution_ns == 0 || step < resolution_ns)) {
+            resolution_ns = step;
+        }
+        prev = t;
+    }
+}
+
+// 单条日志的平均耗时 (ns)
+static double time_logger(spdlog::clock_source source, size_t iterations)
+{
+    auto logger = std::make_shared<spdlog::logger>("clock_bench", std::make_shared<spdlog::sinks::null_sink_st>());
+    logger->set_clock(source);
+    logger->set_level(spdlog::level::info);
+
+    auto start = bench_clock::now();
+    for (size_t i = 0; i < iterations; i++) {
+        logger->info("message #{} from clock_bench", i);
+    }
+    auto end = bench_clock::now();
+    return static_cast<double>(ns_between(start, end)) / static_cast<double>(iterations);
+}
+
+int main(int argc, char *argv[])
+{
+    size_t iterations = 10000000;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            iterations = std::strtoul(argv[++i], nullptr, 10);
+        } else {
+            std::cerr << "usage: clock_bench [-n iterations]" << std::endl;
+            return 2;
+        }
+    }
+    if (iterations == 0) {
+        iterations = 1;
+    }
+
+    auto &tsc = spdlog::details::tsc_clock::instance();
+    if (tsc.available()) {
+        std::printf("tsc: %.0f MHz\n", tsc.ticks_per_second() / 1e6);
+    } else {
+        std::printf("tsc: not available (falls back to precise)\n");
+    }
+
+    std::printf("%-8s %12s %14s %14s %12s\n", "clock", "now (ns)", "max skew (us)", "resolution", "log (ns)");
+    const spdlog::clock_source sources[] = {spdlog::clock_source::precise, spdlog::clock_source::coarse,
+                                            spdlog::clock_source::tsc};
+    for (auto source : sources) {
+        double max_skew_us;
+        long long resolution_ns;
+        measure_accuracy(source, max_skew_us, resolution_ns);
+        auto now_ns = time_clock(source, iterations);
+        auto log_ns = time_logger(source, iterations / 10 + 1);
+        std::printf("%-8s %12.1f %14.2f %11lld ns %12.1f\n", source_name(source), now_ns, max_skew_us, resolution_ns,
+                    log_ns);
+    }
+    return 0;
+}
@@ -92,6 +92,15 @@ inline void init_thread_pool(size_t q_size, size_t thread_count) {
     init_thread_pool(q_size, thread_count, [] {}, [] {});
 }
 
+// set global thread pool with extra options (e.g. per thread staging queues).
+inline void init_thread_pool(size_t q_size,
+                             size_t thread_count,
+                             const details::thread_pool_options &options) {
+    auto tp = std::make_shared<details::thread_pool>(
+        q_size, thread_count, [] {}, [] {}, options);
+    details::registry::instance().set_tp(std::move(tp));
+}
+
 // get the global thread pool.
 inline std::shared_ptr<spdlog::details::thread_pool> thread_pool() {
     return details::registry::instance().get_tp();
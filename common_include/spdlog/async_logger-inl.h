@@ -10,6 +10,7 @@
 #include <spdlog/details/thread_pool.h>
 #include <spdlog/sinks/sink.h>
 
+#include <algorithm>
 #include <memory>
 #include <string>
 
@@ -30,10 +31,52 @@ SPDLOG_INLINE spdlog::async_logger::async_logger(std::string logger_name,
     : async_logger(
           std::move(logger_name), {std::move(single_sink)}, std::move(tp), overflow_policy) {}
 
+SPDLOG_INLINE spdlog::async_logger::async_logger(const async_logger &other)
+    : std::enable_shared_from_this<async_logger>(other),
+      logger(other),
+      thread_pool_(other.thread_pool_),
+      overflow_policy_(other.overflow_policy_),
+      shard_(other.shard_.load(std::memory_order_relaxed)) {}
+
+SPDLOG_INLINE void spdlog::async_logger::init_clock_() {
+    if (auto pool_ptr = thread_pool_.lock()) {
+        set_clock(pool_ptr->clock());
+    }
+}
+
+// make sure the pool keeps this logger alive while it has messages of it in flight.
+// once it does, posting only reads held_by_pool_.
+SPDLOG_INLINE spdlog::details::thread_pool *spdlog::async_logger::hold_pool_(
+    const std::shared_ptr<details::thread_pool> &pool_ptr) {
+    if (!held_by_pool_.load(std::memory_order_acquire)) {
+        pool_ptr->hold_logger(shared_from_this());
+    }
+    return pool_ptr.get();
+}
+
+SPDLOG_INLINE void spdlog::async_logger::on_drop() {
+    if (auto pool_ptr = thread_pool_.lock()) {
+        pool_ptr->release_logger(this);
+    }
+}
+
 // send the log message to the thread pool
 SPDLOG_INLINE void spdlog::async_logger::sink_it_(const details::log_msg &msg){
     SPDLOG_TRY{if (auto pool_ptr = thread_pool_.lock()){
-        pool_ptr -> post_log(shared_from_this(), msg, overflow_policy_);
+        hold_pool_(pool_ptr)->post_log(this, msg, overflow_policy_);
+}
+else {
+    throw_spdlog_ex("async log: thread pool doesn't exist anymore");
+}
+}
+SPDLOG_LOGGER_CATCH(msg.source)
+}
+
+// send the captured arguments to the thread pool, to be formatted there
+SPDLOG_INLINE void spdlog::async_logger::sink_deferred_(const details::log_msg &msg,
+                                                        details::deferred_format_fn format_fn){
+    SPDLOG_TRY{if (auto pool_ptr = thread_pool_.lock()){
+        hold_pool_(pool_ptr)->post_log(this, msg, overflow_policy_, format_fn);
 }
 else {
     throw_spdlog_ex("async log: thread pool doesn't exist anymore");
@@ -45,7 +88,19 @@ SPDLOG_LOGGER_CATCH(msg.source)
 // send flush request to the thread pool
 SPDLOG_INLINE void spdlog::async_logger::flush_(){
     SPDLOG_TRY{if (auto pool_ptr = thread_pool_.lock()){
-        pool_ptr -> post_flush(shared_from_this(), overflow_policy_);
+        hold_pool_(pool_ptr)->post_flush(this, overflow_policy_);
+}
+else {
+    throw_spdlog_ex("async flush: thread pool doesn't exist anymore");
+}
+}
+SPDLOG_LOGGER_CATCH(source_loc())
+}
+
+// send the flush asked for by flush_on() or flush_every() to the thread pool
+SPDLOG_INLINE void spdlog::async_logger::request_flush_(){
+    SPDLOG_TRY{if (auto pool_ptr = thread_pool_.lock()){
+        hold_pool_(pool_ptr)->post_flush_request(this, overflow_policy_);
 }
 else {
     throw_spdlog_ex("async flush: thread pool doesn't exist anymore");
@@ -58,18 +113,86 @@ SPDLOG_LOGGER_CATCH(source_loc())
 // backend functions - called from the thread pool to do the actual job
 //
 SPDLOG_INLINE void spdlog::async_logger::backend_sink_it_(const details::log_msg &msg) {
-    for (auto &sink : sinks_) {
-        if (sink->should_log(msg.level)) {
-            SPDLOG_TRY { sink->log(msg); }
+    if (sinks_.size() == 1) {
+        if (sinks_[0]->should_log(msg.level)) {
+            SPDLOG_TRY { sinks_[0]->log(msg); }
             SPDLOG_LOGGER_CATCH(msg.source)
         }
+    } else {
+        // sinks with the same format share the formatted message
+        details::shared_format shared;
+        for (auto &sink : sinks_) {
+            if (sink->should_log(msg.level)) {
+                SPDLOG_TRY { sink->log_formatted(msg, shared); }
+                SPDLOG_LOGGER_CATCH(msg.source)
+            }
+        }
     }
 
     if (should_flush_(msg)) {
-        backend_flush_();
+        backend_request_flush_();
     }
 }
 
+// hand a run of messages to each sink in one call, skipping the messages below the sink's level.
+// sinks with the same format share the formatted run, like in backend_sink_it_().
+SPDLOG_INLINE void spdlog::async_logger::backend_sink_batch_(const details::log_msg *const *msgs,
+                                                             size_t count) {
+    const size_t chunk_size = 64;
+    const details::log_msg *filtered[chunk_size];
+    bool need_flush = false;
+    for (size_t i = 0; i < count; i++) {
+        need_flush = need_flush || should_flush_(*msgs[i]);
+    }
+
+    details::shared_batch_format shared;
+    for (size_t chunk = 0; chunk < count; chunk += chunk_size) {
+        auto chunk_end = (std::min)(count, chunk + chunk_size);
+        shared.format_id = 0;
+        for (auto &sink : sinks_) {
+            size_t n = 0;
+            for (size_t i = chunk; i < chunk_end; i++) {
+                if (sink->should_log(msgs[i]->level)) {
+                    filtered[n++] = msgs[i];
+                }
+            }
+            if (n == 0) {
+                continue;
+            }
+            SPDLOG_TRY {
+                if (sinks_.size() == 1) {
+                    sink->log_batch(filtered, n);
+                } else {
+                    sink->log_batch_formatted(filtered, n, shared);
+                }
+            }
+            SPDLOG_LOGGER_CATCH(filtered[0]->source)
+        }
+    }
+
+    if (need_flush) {
+        backend_request_flush_();
+    }
+}
+
+SPDLOG_INLINE bool spdlog::async_logger::backend_format_(details::async_msg &msg) {
+    SPDLOG_TRY {
+        msg.format_deferred();
+        return true;
+    }
+    SPDLOG_LOGGER_CATCH(msg.source)
+    return false;
+}
+
+SPDLOG_INLINE bool spdlog::async_logger::backend_needs_payload_() {
+    for (auto &sink : sinks_) {
+        if (sink->needs_payload()) {
+            return true;
+        }
+    }
+    return false;
+}
+
 SPDLOG_INLINE void spdlog::async_logger::backend_flush_() {
     for (auto &sink : sinks_) {
         SPDLOG_TRY { sink->flush(); }
@@ -77,6 +200,29 @@ SPDLOG_INLINE void spdlog::async_logger::backend_flush_() {
     }
 }
 
+SPDLOG_INLINE void spdlog::async_logger::backend_request_flush_() {
+    for (auto &sink : sinks_) {
+        SPDLOG_TRY { sink->request_flush(); }
+        SPDLOG_LOGGER_CATCH(source_loc())
+    }
+}
+
+SPDLOG_INLINE void spdlog::async_logger::set_deferred_format(bool enabled) {
+    deferred_format_.store(enabled, std::memory_order_relaxed);
+}
+
+SPDLOG_INLINE bool spdlog::async_logger::deferred_format() const {
+    return deferred_format_.load(std::memory_order_relaxed);
+}
+
+SPDLOG_INLINE void spdlog::async_logger::set_shard(size_t shard) {
+    shard_.store(shard, std::memory_order_relaxed);
+}
+
+SPDLOG_INLINE size_t spdlog::async_logger::shard() const {
+    return shard_.load(std::memory_order_relaxed);
+}
+
 SPDLOG_INLINE std::shared_ptr<spdlog::logger> spdlog::async_logger::clone(std::string new_name) {
     auto cloned = std::make_shared<spdlog::async_logger>(*this);
     cloned->name_ = std::move(new_name);
@@ -16,6 +16,11 @@
 
 #include <spdlog/logger.h>
 
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+
 namespace spdlog {
 
 // Async overflow policy - block by default.
@@ -28,6 +33,7 @@ enum class async_overflow_policy {
 
 namespace details {
 class thread_pool;
+struct async_msg;
 }
 
 class SPDLOG_API async_logger final : public std::enable_shared_from_this<async_logger>,
@@ -43,7 +49,10 @@ public:
                  async_overflow_policy overflow_policy = async_overflow_policy::block)
         : logger(std::move(logger_name), begin, end),
           thread_pool_(std::move(tp)),
-          overflow_policy_(overflow_policy) {}
+          overflow_policy_(overflow_policy),
+          shard_(std::hash<std::string>()(name_)) {
+        init_clock_();
+    }
 
     async_logger(std::string logger_name,
                  sinks_init_list sinks_list,
@@ -55,17 +64,53 @@ public:
                  std::weak_ptr<details::thread_pool> tp,
                  async_overflow_policy overflow_policy = async_overflow_policy::block);
 
+    async_logger(const async_logger &other);
+
     std::shared_ptr<logger> clone(std::string new_name) override;
 
+    // capture the arguments of log calls and format them on the thread pool instead of the
+    // calling thread. only calls whose arguments are all arithmetic, enums or strings are
+    // deferred (strings are copied). the others, and all calls while backtrace is enabled,
+    // are formatted as usual.
+    void set_deferred_format(bool enabled);
+    bool deferred_format() const;
+
+    // shard of a sharded thread pool (see thread_pool_options::sharded) that handles the
+    // messages of this logger, modulo the number of shards. defaults to a hash of the name.
+    // set it before logging: messages still queued on the previous shard may be handled
+    // after newer ones.
+    void set_shard(size_t shard);
+    size_t shard() const;
+
+    // let the thread pool release this logger once it has processed the messages logged so far
+    // (see thread_pool::release_logger()). logging again makes the pool keep it again.
+    void on_drop() override;
+
 protected:
     void sink_it_(const details::log_msg &msg) override;
+    void sink_deferred_(const details::log_msg &msg, details::deferred_format_fn format_fn) override;
     void flush_() override;
+    void request_flush_() override;
     void backend_sink_it_(const details::log_msg &incoming_log_msg);
+    void backend_sink_batch_(const details::log_msg *const *msgs, size_t count);
     void backend_flush_();
+    void backend_request_flush_();
+    // format a deferred message in place. return false (and report the error) on failure.
+    bool backend_format_(details::async_msg &msg);
+    // whether any sink needs deferred messages formatted (see sink::needs_payload())
+    bool backend_needs_payload_();
 
 private:
     std::weak_ptr<details::thread_pool> thread_pool_;
     async_overflow_policy overflow_policy_;
+
+    // set while the thread pool keeps a reference to this logger (see thread_pool::hold_logger)
+    std::atomic<bool> held_by_pool_{false};
+    std::atomic<size_t> shard_;
+
+    // start with the clock of the thread pool (see thread_pool_options::clock)
+    void init_clock_();
+    details::thread_pool *hold_pool_(const std::shared_ptr<details::thread_pool> &pool_ptr);
 };
 }  // namespace spdlog
 
@@ -8,6 +8,7 @@
 
 #include <atomic>
 #include <chrono>
+#include <cstdint>
 #include <cstdio>
 #include <exception>
 #include <functional>
@@ -296,6 +297,15 @@ enum class pattern_time_type {
     utc     // log utc
 };
 
+//
+// Clock used to timestamp log messages (see details/clock.h).
+//
+enum class clock_source {
+    precise,  // log_clock::now() (CLOCK_REALTIME_COARSE if SPDLOG_CLOCK_COARSE is defined)
+    coarse,   // CLOCK_REALTIME_COARSE on linux (resolution of a few ms), precise elsewhere
+    tsc       // cpu time stamp counter, calibrated against log_clock and resynced periodically
+};
+
 //
 // Log exception
 //
@@ -318,13 +328,38 @@ struct source_loc {
         : filename{filename_in},
           line{line_in},
           funcname{funcname_in} {}
+    SPDLOG_CONSTEXPR source_loc(const char *filename_in,
+                                int line_in,
+                                const char *funcname_in,
+                                std::uint32_t site_id_in)
+        : filename{filename_in},
+          line{line_in},
+          site_id{site_id_in},
+          funcname{funcname_in} {}
 
     SPDLOG_CONSTEXPR bool empty() const SPDLOG_NOEXCEPT { return line <= 0; }
     const char *filename{nullptr};
     int line{0};
+    // id of the log macro call site (see details/call_site.h), 0 if none
+    std::uint32_t site_id{0};
     const char *funcname{nullptr};
 };
 
+// structured field of a log call, see kv()
+template <typename T>
+struct kv_field {
+    string_view_t key;
+    const T &value;
+};
+
+// key/value field for logger::log(lvl, msg, kv("user_id", id), ..).
+// arithmetic, enum and string values are stored typed with the message (see details/fields.h)
+// and only rendered by the formatter (%K, %J) or written as is by the binary sinks.
+template <typename T>
+kv_field<T> kv(string_view_t key, const T &value) {
+    return kv_field<T>{key, value};
+}
+
 struct file_event_handlers {
     file_event_handlers()
         : before_open(nullptr),
@@ -338,6 +373,60 @@ struct file_event_handlers {
     std::function<void(const filename_t &filename)> after_close;
 };
 
+// How file sinks use the page cache (see file_options::cache_mode).
+enum class file_cache_mode {
+    // regular buffered writes
+    normal,
+    // write with O_DIRECT, bypassing the page cache (linux, see details/direct_file_writer.h).
+    // Falls back to normal on file systems without O_DIRECT.
+    direct,
+    // regular writes, but every megabyte written is handed to the disk (sync_file_range) and
+    // dropped from the page cache (posix_fadvise DONTNEED) once written back (linux)
+    dontneed
+};
+
+// Settings of the file sinks (see details/file_helper.h).
+// Constructible from the event handlers, so it can be passed where only those were expected.
+struct file_options {
+    file_options() = default;
+    file_options(const file_event_handlers &handlers)
+        : event_handlers(handlers) {}
+
+    file_event_handlers event_handlers;
+
+    // Write through io_uring (linux 5.6+, see details/io_uring_writer.h). The messages are
+    // copied into io_uring_depth buffers of io_uring_buffer_size bytes, and each buffer is
+    // submitted when full or on flush, so writes and flushes don't wait for the disk (unless all
+    // the buffers are in flight). Write errors are reported by the next write or flush.
+    // Falls back to stdio if io_uring is not available.
+    bool io_uring = false;
+    size_t io_uring_depth = 4;
+    size_t io_uring_buffer_size = 64 * 1024;
+    // submit an fdatasync after the data of each flush
+    bool io_uring_datasync = false;
+
+    // Size of the stdio write buffer of the file (0: the stdio default, a few KB). Data is
+    // written when the buffer is full or on flush. (with io_uring the buffering is set by
+    // io_uring_depth and io_uring_buffer_size: a depth of 2 fills one buffer while the other
+    // is being written)
+    size_t buffer_size = 0;
+
+    // Flush policy. If set, the sink flushes only once flush_bytes bytes are pending or the
+    // oldest pending data is flush_interval old, after a write and on the flushes of flush_on
+    // and flush_every. logger::flush(), rotation and closing the file still flush right away,
+    // so data held back is written by one of them if the policy is never due.
+    size_t flush_bytes = 0;
+    std::chrono::milliseconds flush_interval{0};
+
+    // Keep the log data out of the page cache. (not with io_uring) With direct, buffer_size
+    // sets the size of the aligned write buffer (1 MB by default).
+    file_cache_mode cache_mode = file_cache_mode::normal;
+
+    // rotating_file_sink: open the next file and rename the files on a housekeeping thread, so
+    // that a rotation only switches to the already open file. (not on windows)
+    bool background_rotation = false;
+};
+
 namespace details {
 
 // to_string_view
@@ -0,0 +1,390 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#ifndef SPDLOG_HEADER_ONLY
+    #include <spdlog/details/binary_log.h>
+#endif
+
+#include <spdlog/details/call_site.h>
+#include <spdlog/details/deferred_format.h>
+#include <spdlog/fmt/args.h>
+
+#include <chrono>
+#include <cstring>
+
+namespace spdlog {
+namespace details {
+
+static const char binary_log_magic[8] = {'S', 'P', 'D', 'L', 'O', 'G', 'B', '\2'};
+static const std::uint32_t binary_log_byte_order = 0x01020304;
+
+inline void binary_write_varint(memory_buf_t &dest, std::uint64_t value) {
+    while (value >= 0x80) {
+        dest.push_back(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    dest.push_back(static_cast<char>(value));
+}
+
+// fnv-1a
+inline std::uint64_t binary_hash(string_view_t s) {
+    std::uint64_t h = 14695981039346656037ULL;
+    for (auto c : s) {
+        h = (h ^ static_cast<unsigned char>(c)) * 1099511628211ULL;
+    }
+    return h;
+}
+
+//
+// binary_log_encoder
+//
+SPDLOG_INLINE void binary_log_encoder::begin(bool new_file, memory_buf_t &dest) {
+    ids_.clear();
+    strings_.clear();
+    site_ids_.clear();
+    last_time_ = 0;
+    committed_strings_ = 0;
+    committed_time_ = 0;
+    new_file_ = new_file;
+    header_pending_ = true;
+    rewrite_header_ = false;
+    write_header_(dest);
+}
+
+SPDLOG_INLINE void binary_log_encoder::write_header_(memory_buf_t &dest) {
+    if (new_file_) {
+        deferred_append(dest, binary_log_magic, sizeof(binary_log_magic));
+        deferred_append(dest, &binary_log_byte_order, sizeof(binary_log_byte_order));
+    } else {
+        dest.push_back(static_cast<char>(binary_record::reset));
+        dest.push_back(static_cast<char>(binary_record::version));
+        dest.push_back(binary_log_magic[sizeof(binary_log_magic) - 1]);
+    }
+}
+
+SPDLOG_INLINE void binary_log_encoder::encode(const log_msg &msg, memory_buf_t &dest) {
+    if (rewrite_header_) {
+        write_header_(dest);
+        rewrite_header_ = false;
+    }
+    string_view_t fmt{"{}", 2};
+    string_view_t args;
+    if (msg.deferred_args.size() > 0) {
+        const char *p = msg.deferred_args.data();
+        fmt = deferred_read_string(p);
+        auto fmt_end = static_cast<size_t>(p - msg.deferred_args.data());
+        args = string_view_t{p, msg.deferred_args.size() - fmt_end};
+    }
+
+    auto fmt_id = intern_(fmt, dest);
+    auto logger_id = intern_(msg.logger_name, dest);
+    std::uint32_t file_id = 0;
+    std::uint32_t func_id = 0;
+    if (!msg.source.empty()) {
+        auto site_id = msg.source.site_id;
+        if (site_id != 0 && site_id < site_ids_.size() && site_ids_[site_id].first != 0) {
+            file_id = site_ids_[site_id].first;
+            func_id = site_ids_[site_id].second;
+        } else {
+            file_id = intern_(source_filename(msg.source), dest);
+            func_id = intern_(source_funcname(msg.source), dest);
+            if (site_id != 0) {
+                if (site_id >= site_ids_.size()) {
+                    site_ids_.resize(site_id + 1);
+                }
+                site_ids_[site_id] = std::make_pair(file_id, func_id);
+            }
+        }
+    }
+
+    auto time = static_cast<std::int64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(msg.time.time_since_epoch()).count());
+    auto delta = time - last_time_;
+    last_time_ = time;
+
+    dest.push_back(static_cast<char>(binary_record::message));
+    binary_write_varint(dest, fmt_id);
+    binary_write_varint(dest, logger_id);
+    binary_write_varint(dest, (static_cast<std::uint64_t>(delta) << 1) ^
+                                  static_cast<std::uint64_t>(delta >> 63));
+    binary_write_varint(dest, msg.thread_id);
+    dest.push_back(static_cast<char>(msg.level));
+    binary_write_varint(dest, file_id);
+    if (file_id != 0) {
+        binary_write_varint(dest, static_cast<std::uint32_t>(msg.source.line));
+        binary_write_varint(dest, func_id);
+    }
+
+    if (msg.deferred_args.size() > 0) {
+        binary_write_varint(dest, args.size());
+        deferred_append(dest, args.data(), args.size());
+    } else {
+        binary_write_varint(dest, 1 + sizeof(std::uint32_t) + msg.payload.size());
+        deferred_write_type(dest, deferred_arg_type::string);
+        deferred_write_string(dest, msg.payload.data(), msg.payload.size());
+    }
+    binary_write_varint(dest, msg.fields.size());
+    deferred_append(dest, msg.fields.data(), msg.fields.size());
+}
+
+SPDLOG_INLINE void binary_log_encoder::commit() {
+    committed_strings_ = strings_.size();
+    committed_time_ = last_time_;
+    header_pending_ = false;
+    rewrite_header_ = false;
+}
+
+SPDLOG_INLINE void binary_log_encoder::rollback() {
+    if (strings_.size() != committed_strings_) {
+        for (auto it = ids_.begin(); it != ids_.end();) {
+            if (it->second > committed_strings_) {
+                it = ids_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        for (auto &site : site_ids_) {
+            if (site.first > committed_strings_ || site.second > committed_strings_) {
+                site = std::make_pair(0u, 0u);
+            }
+        }
+        strings_.resize(committed_strings_);
+    }
+    last_time_ = committed_time_;
+    rewrite_header_ = header_pending_;
+}
+
+SPDLOG_INLINE std::uint32_t binary_log_encoder::intern_(string_view_t s, memory_buf_t &dest) {
+    auto hash = binary_hash(s);
+    auto range = ids_.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it) {
+        const auto &known = strings_[it->second - 1];
+        if (known.size() == s.size() && std::memcmp(known.data(), s.data(), s.size()) == 0) {
+            return it->second;
+        }
+    }
+
+    auto id = static_cast<std::uint32_t>(strings_.size() + 1);
+    strings_.emplace_back(s.data(), s.size());
+    ids_.emplace(hash, id);
+
+    dest.push_back(static_cast<char>(binary_record::dictionary));
+    binary_write_varint(dest, id);
+    binary_write_varint(dest, s.size());
+    deferred_append(dest, s.data(), s.size());
+    return id;
+}
+
+//
+// binary_log_decoder
+//
+SPDLOG_INLINE binary_log_decoder::binary_log_decoder(string_view_t data)
+    : pos_{data.data()},
+      end_{data.data() + data.size()} {
+    std::uint32_t byte_order = 0;
+    const auto version_offset = sizeof(binary_log_magic) - 1;
+    if (data.size() < sizeof(binary_log_magic) + sizeof(byte_order) ||
+        std::memcmp(pos_, binary_log_magic, version_offset) != 0) {
+        throw_spdlog_ex("binary log: bad file header");
+    }
+    set_version_(pos_[version_offset]);
+    pos_ += sizeof(binary_log_magic);
+    std::memcpy(&byte_order, read_bytes_(sizeof(byte_order)), sizeof(byte_order));
+    if (byte_order != binary_log_byte_order) {
+        throw_spdlog_ex("binary log: written with a different byte order");
+    }
+}
+
+SPDLOG_INLINE bool binary_log_decoder::next(log_msg &msg) {
+    while (pos_ < end_) {
+        auto record = static_cast<binary_record>(*read_bytes_(1));
+        switch (record) {
+            case binary_record::dictionary: {
+                auto id = read_varint_();
+                auto size = static_cast<size_t>(read_varint_());
+                const char *bytes = read_bytes_(size);
+                if (id != strings_.size() + 1) {
+                    throw_spdlog_ex("binary log: unexpected dictionary id " + std::to_string(id));
+                }
+                strings_.emplace_back(bytes, size);
+                break;
+            }
+
+            case binary_record::reset:
+                strings_.clear();
+                last_time_ = 0;
+                break;
+
+            case binary_record::version:
+                set_version_(*read_bytes_(1));
+                break;
+
+            case binary_record::message: {
+                const auto &fmt = lookup_(read_varint_());
+                const auto &logger_name = lookup_(read_varint_());
+                auto delta = read_varint_();
+                last_time_ += static_cast<std::int64_t>(delta >> 1) ^
+                              -static_cast<std::int64_t>(delta & 1);
+                auto thread_id = static_cast<size_t>(read_varint_());
+                auto lvl = static_cast<unsigned char>(*read_bytes_(1));
+                if (lvl >= level::n_levels) {
+                    throw_spdlog_ex("binary log: bad level " + std::to_string(lvl));
+                }
+                source_loc source;
+                auto file_id = read_varint_();
+                if (file_id != 0) {
+                    auto line = static_cast<int>(read_varint_());
+                    const auto &funcname = lookup_(read_varint_());
+                    source = source_loc{lookup_(file_id).c_str(), line, funcname.c_str()};
+                }
+                auto args_size = static_cast<size_t>(read_varint_());
+                const char *args = read_bytes_(args_size);
+                string_view_t fields;
+                if (version_ >= 2) {
+                    auto fields_size = static_cast<size_t>(read_varint_());
+                    fields = string_view_t{read_bytes_(fields_size), fields_size};
+                }
+
+                format_payload_(string_view_t{fmt.data(), fmt.size()},
+                                string_view_t{args, args_size});
+                auto time = log_clock::time_point{std::chrono::duration_cast<log_clock::duration>(
+                    std::chrono::nanoseconds{last_time_})};
+                msg = log_msg{time, source, string_view_t{logger_name.data(), logger_name.size()},
+                              static_cast<level::level_enum>(lvl),
+                              string_view_t{payload_.data(), payload_.size()}};
+                msg.thread_id = thread_id;
+                msg.fields = fields;
+                return true;
+            }
+
+            default:
+                throw_spdlog_ex("binary log: unknown record type " +
+                                std::to_string(static_cast<int>(record)));
+        }
+    }
+    return false;
+}
+
+SPDLOG_INLINE void binary_log_decoder::set_version_(char version) {
+    if (version < 1 || version > binary_log_magic[sizeof(binary_log_magic) - 1]) {
+        throw_spdlog_ex("binary log: unsupported version " +
+                        std::to_string(static_cast<int>(version)));
+    }
+    version_ = version;
+}
+
+SPDLOG_INLINE std::uint64_t binary_log_decoder::read_varint_() {
+    std::uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        auto byte = static_cast<unsigned char>(*read_bytes_(1));
+        value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) {
+            return value;
+        }
+    }
+    throw_spdlog_ex("binary log: bad varint");
+}
+
+SPDLOG_INLINE const char *binary_log_decoder::read_bytes_(size_t size) {
+    if (static_cast<size_t>(end_ - pos_) < size) {
+        throw_spdlog_ex("binary log: truncated record");
+    }
+    const char *p = pos_;
+    pos_ += size;
+    return p;
+}
+
+SPDLOG_INLINE const std::string &binary_log_decoder::lookup_(std::uint64_t id) const {
+    if (id == 0 || id > strings_.size()) {
+        throw_spdlog_ex("binary log: unknown dictionary id " + std::to_string(id));
+    }
+    return strings_[static_cast<size_t>(id - 1)];
+}
+
+template <typename T>
+T binary_read_arg(const char *&p, const char *end) {
+    T value;
+    if (static_cast<size_t>(end - p) < sizeof(T)) {
+        throw_spdlog_ex("binary log: truncated argument");
+    }
+    std::memcpy(&value, p, sizeof(T));
+    p += sizeof(T);
+    return value;
+}
+
+SPDLOG_INLINE void binary_log_decoder::format_payload_(string_view_t format_str,
+                                                       string_view_t args) {
+    payload_.clear();
+#ifdef SPDLOG_USE_STD_FORMAT
+    (void)format_str;
+    (void)args;
+    throw_spdlog_ex("binary log: decoding requires fmt (SPDLOG_USE_STD_FORMAT is defined)");
+#else
+    fmt::dynamic_format_arg_store<fmt::format_context> store;
+    const char *p = args.data();
+    const char *end = args.data() + args.size();
+    while (p < end) {
+        auto type = static_cast<deferred_arg_type>(*p++);
+        switch (type) {
+            case deferred_arg_type::boolean:
+                store.push_back(binary_read_arg<bool>(p, end));
+                break;
+            case deferred_arg_type::character:
+                store.push_back(binary_read_arg<char>(p, end));
+                break;
+            case deferred_arg_type::int8:
+                store.push_back(binary_read_arg<std::int8_t>(p, end));
+                break;
+            case deferred_arg_type::int16:
+                store.push_back(binary_read_arg<std::int16_t>(p, end));
+                break;
+            case deferred_arg_type::int32:
+                store.push_back(binary_read_arg<std::int32_t>(p, end));
+                break;
+            case deferred_arg_type::int64:
+                store.push_back(binary_read_arg<std::int64_t>(p, end));
+                break;
+            case deferred_arg_type::uint8:
+                store.push_back(binary_read_arg<std::uint8_t>(p, end));
+                break;
+            case deferred_arg_type::uint16:
+                store.push_back(binary_read_arg<std::uint16_t>(p, end));
+                break;
+            case deferred_arg_type::uint32:
+                store.push_back(binary_read_arg<std::uint32_t>(p, end));
+                break;
+            case deferred_arg_type::uint64:
+                store.push_back(binary_read_arg<std::uint64_t>(p, end));
+                break;
+            case deferred_arg_type::float32:
+                store.push_back(binary_read_arg<float>(p, end));
+                break;
+            case deferred_arg_type::float64:
+                store.push_back(binary_read_arg<double>(p, end));
+                break;
+            case deferred_arg_type::float_long:
+                store.push_back(binary_read_arg<long double>(p, end));
+                break;
+            case deferred_arg_type::string: {
+                auto size = binary_read_arg<std::uint32_t>(p, end);
+                if (static_cast<size_t>(end - p) < size) {
+                    throw_spdlog_ex("binary log: truncated argument");
+                }
+                store.push_back(fmt::string_view{p, size});
+                p += size;
+                break;
+            }
+            default:
+                throw_spdlog_ex("binary log: unknown argument type " +
+                                std::to_string(static_cast<int>(type)));
+        }
+    }
+    fmt::vformat_to(fmt::appender(payload_), fmt::string_view{format_str.data(), format_str.size()},
+                    store);
+#endif
+}
+
+}  // namespace details
+}  // namespace spdlog
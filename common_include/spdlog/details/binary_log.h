@@ -0,0 +1,108 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// Compact binary log format (see sinks/binary_file_sink.h).
+//
+// A file starts with an 8 byte magic "SPDLOGB" + version byte (currently 2) and a uint32
+// 0x01020304 in the byte order of the writer. Then come records, each starting with a binary_record byte:
+//
+//   dictionary: [id][size][bytes]
+//       defines string id (format strings, logger names, source file and function names).
+//       every string is written once, before the first message that uses it.
+//   message:    [fmt id][logger id][time delta][thread id][level][file id]
+//               ([line][func id] if file id != 0)[args size][args][fields size][fields]
+//       time delta is the distance in ns to the previous message (zigzag encoded, since
+//       async loggers may reorder messages slightly). args are the tagged arguments of
+//       details/deferred_format.h. Messages that were formatted by the caller are stored
+//       with the "{}" format and their text as single string argument. fields are the
+//       structured fields of details/fields.h (not present in version 1 files).
+//   reset:      forget all ids and set the time base back to 0. written when a sink appends
+//               to an existing file, followed by a version record.
+//   version:    [version] format version of the following records (the file may have been
+//               started by an older writer).
+//
+// All numbers except level and the raw argument bytes are LEB128 varints.
+// Argument bytes are in the writer's native representation.
+
+#include <spdlog/details/log_msg.h>
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace spdlog {
+namespace details {
+
+enum class binary_record : unsigned char { dictionary = 1, message = 2, reset = 3, version = 4 };
+
+class SPDLOG_API binary_log_encoder {
+public:
+    // start a new file (header) or continue an existing one (reset record)
+    void begin(bool new_file, memory_buf_t &dest);
+
+    // append the records of msg (new dictionary entries and the message itself) to dest
+    void encode(const log_msg &msg, memory_buf_t &dest);
+
+    // call commit() once the records encoded so far are written. rollback() forgets the ids
+    // (and time base) of the records encoded since, so that a failed write doesn't leave later
+    // records referring to dictionary entries that aren't in the file.
+    void commit();
+    void rollback();
+
+private:
+    void write_header_(memory_buf_t &dest);
+    std::uint32_t intern_(string_view_t s, memory_buf_t &dest);
+
+    // ids by string hash. lookups compare against strings_ and don't allocate.
+    std::unordered_multimap<std::uint64_t, std::uint32_t> ids_;
+    std::vector<std::string> strings_;
+    // (file id, func id) by call site id, so known call sites skip the lookups
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> site_ids_;
+    std::int64_t last_time_{0};
+
+    // state as of the last commit()
+    size_t committed_strings_{0};
+    std::int64_t committed_time_{0};
+    bool new_file_{true};
+    bool header_pending_{false};  // the header of begin() isn't committed yet
+    bool rewrite_header_{false};  // and it was rolled back
+};
+
+// Reads back the messages of a binary log.
+// Throws spdlog_ex on malformed input.
+class SPDLOG_API binary_log_decoder {
+public:
+    // data must stay valid while the decoder is used
+    explicit binary_log_decoder(string_view_t data);
+
+    // decode the next message into msg, with its payload formatted.
+    // the string views of msg are valid until the next call.
+    // return false at the end of the data.
+    bool next(log_msg &msg);
+
+private:
+    void set_version_(char version);
+    std::uint64_t read_varint_();
+    const char *read_bytes_(size_t size);
+    const std::string &lookup_(std::uint64_t id) const;
+    void format_payload_(string_view_t format_str, string_view_t args);
+
+    const char *pos_;
+    const char *end_;
+    std::deque<std::string> strings_;  // deque: c_str() must stay valid for source_loc
+    std::int64_t last_time_{0};
+    char version_{0};
+    memory_buf_t payload_;
+};
+
+}  // namespace details
+}  // namespace spdlog
+
+#ifdef SPDLOG_HEADER_ONLY
+    #include "binary_log-inl.h"
+#endif
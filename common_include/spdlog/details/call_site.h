@@ -0,0 +1,287 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// Static descriptors of the SPDLOG_LOGGER_CALL call sites (see spdlog.h).
+//
+// Each call site creates its descriptor the first time it runs, with the lengths of the file and
+// function names and the offset of the file's basename resolved once. The descriptor registers
+// itself in a process wide table and the source_loc of its messages carries only its id, so
+// formatters and sinks look the descriptor up instead of scanning the strings again.
+//
+// A descriptor also has an enabled switch, checked by the macro before anything else (one relaxed
+// load), which spdlog::set_call_sites_enabled() flips at runtime by "file:line" pattern. The
+// patterns are kept as rules and applied to the call sites that run for the first time later.
+//
+// Descriptors are never unregistered: call sites in shared libraries must not log after the
+// library is unloaded (the same holds for the __FILE__ pointers of source_loc).
+
+#include <spdlog/common.h>
+#include <spdlog/details/os.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace spdlog {
+namespace details {
+
+class call_site {
+public:
+    // args is the source text of the macro's arguments (#__VA_ARGS__)
+    call_site(const char *filename, int line, const char *funcname, const char *args);
+
+    call_site(const call_site &) = delete;
+    call_site &operator=(const call_site &) = delete;
+
+    source_loc loc() const { return source_loc{filename_, line_, funcname_, id_}; }
+
+    bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+    void set_enabled(bool enabled) { enabled_.store(enabled, std::memory_order_relaxed); }
+
+    std::uint32_t id() const { return id_; }
+    int line() const { return line_; }
+    string_view_t filename() const { return string_view_t{filename_, filename_size_}; }
+    string_view_t basename() const {
+        return string_view_t{filename_ + basename_offset_, filename_size_ - basename_offset_};
+    }
+    string_view_t funcname() const { return string_view_t{funcname_, funcname_size_}; }
+    // the format string as written in the source (escapes not processed), empty if the first
+    // argument isn't a string literal
+    string_view_t format() const { return string_view_t{args_ + format_offset_, format_size_}; }
+
+private:
+    const char *filename_;
+    const char *funcname_;
+    const char *args_;
+    int line_;
+    std::uint32_t id_;
+    std::uint32_t filename_size_;
+    std::uint32_t basename_offset_;
+    std::uint32_t funcname_size_;
+    std::uint32_t format_offset_;
+    std::uint32_t format_size_;
+    std::atomic<bool> enabled_{true};
+};
+
+// glob match with '*' (any run of chars) and '?' (any char)
+inline bool glob_match(string_view_t pattern, string_view_t text) {
+    size_t p = 0, t = 0;
+    size_t star = 0, star_t = 0;
+    bool have_star = false;
+    while (t < text.size()) {
+        if (p < pattern.size() && (pattern[p] == '?' || pattern[p] == text[t])) {
+            p++;
+            t++;
+        } else if (p < pattern.size() && pattern[p] == '*') {
+            star = p++;
+            star_t = t;
+            have_star = true;
+        } else if (have_star) {
+            p = star + 1;
+            t = ++star_t;
+        } else {
+            return false;
+        }
+    }
+    while (p < pattern.size() && pattern[p] == '*') {
+        p++;
+    }
+    return p == pattern.size();
+}
+
+// id -> call_site table. lookups don't lock.
+class call_site_registry {
+public:
+    static const size_t chunk_size = 1024;
+    static const size_t max_chunks = 1024;
+
+    // never destroyed: call sites may still log from static destructors
+    static call_site_registry &instance() {
+        static call_site_registry *registry = new call_site_registry();
+        return *registry;
+    }
+
+    // apply the rules to site and return its id (0 if the table is full)
+    std::uint32_t add(call_site *site) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto &rule : rules_) {
+            if (matches_(*site, rule.first)) {
+                site->set_enabled(rule.second);
+            }
+        }
+        auto index = size_.load(std::memory_order_relaxed);
+        if (index / chunk_size >= max_chunks) {
+            return 0;
+        }
+        auto &chunk = chunks_[index / chunk_size];
+        auto *slots = chunk.load(std::memory_order_relaxed);
+        if (slots == nullptr) {
+            slots = new std::atomic<call_site *>[chunk_size];
+            chunk.store(slots, std::memory_order_release);
+        }
+        slots[index % chunk_size].store(site, std::memory_order_release);
+        size_.store(index + 1, std::memory_order_release);
+        return static_cast<std::uint32_t>(index + 1);
+    }
+
+    // the site with the given id, nullptr for 0 or unknown ids
+    const call_site *find(std::uint32_t id) const {
+        if (id == 0 || id > size_.load(std::memory_order_acquire)) {
+            return nullptr;
+        }
+        size_t index = id - 1;
+        auto *slots = chunks_[index / chunk_size].load(std::memory_order_acquire);
+        return slots[index % chunk_size].load(std::memory_order_acquire);
+    }
+
+    size_t size() const { return size_.load(std::memory_order_acquire); }
+
+    // enable or disable the sites matching pattern, now and when they register later.
+    // returns the number of registered sites that matched.
+    size_t set_enabled(const std::string &pattern, bool enabled) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        // a later rule for the same pattern replaces the earlier one
+        rules_.erase(std::remove_if(rules_.begin(), rules_.end(),
+                                    [&](const std::pair<std::string, bool> &rule) {
+                                        return rule.first == pattern;
+                                    }),
+                     rules_.end());
+        rules_.emplace_back(pattern, enabled);
+        size_t matched = 0;
+        for_each_(size_.load(std::memory_order_relaxed), [&](call_site &site) {
+            if (matches_(site, pattern)) {
+                site.set_enabled(enabled);
+                matched++;
+            }
+        });
+        return matched;
+    }
+
+    // forget the rules and enable all sites
+    void enable_all() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        rules_.clear();
+        for_each_(size_.load(std::memory_order_relaxed),
+                  [](call_site &site) { site.set_enabled(true); });
+    }
+
+    template <typename F>
+    void for_each(F &&f) {
+        for_each_(size(), [&](const call_site &site) { f(site); });
+    }
+
+private:
+    call_site_registry() {
+        for (auto &chunk : chunks_) {
+            chunk.store(nullptr, std::memory_order_relaxed);
+        }
+    }
+
+    template <typename F>
+    void for_each_(size_t count, F &&f) {
+        for (size_t i = 0; i < count; i++) {
+            auto *slots = chunks_[i / chunk_size].load(std::memory_order_acquire);
+            f(*slots[i % chunk_size].load(std::memory_order_acquire));
+        }
+    }
+
+    // the pattern is matched against "file:line" and "basename:line"
+    static bool matches_(const call_site &site, const std::string &pattern) {
+        auto line = std::to_string(site.line());
+        auto filename = site.filename();
+        std::string text(filename.data(), filename.size());
+        text += ':';
+        text += line;
+        if (glob_match(pattern, text)) {
+            return true;
+        }
+        auto basename_size = site.basename().size() + 1 + line.size();
+        return glob_match(pattern,
+                          string_view_t{text.data() + text.size() - basename_size, basename_size});
+    }
+
+    std::mutex mutex_;
+    std::atomic<size_t> size_{0};
+    std::atomic<std::atomic<call_site *> *> chunks_[max_chunks];
+    std::vector<std::pair<std::string, bool>> rules_;
+};
+
+inline call_site::call_site(const char *filename, int line, const char *funcname, const char *args)
+    : filename_(filename != nullptr ? filename : ""),
+      funcname_(funcname != nullptr ? funcname : ""),
+      args_(args != nullptr ? args : ""),
+      line_(line),
+      id_(0),
+      filename_size_(static_cast<std::uint32_t>(std::strlen(filename_))),
+      basename_offset_(0),
+      funcname_size_(static_cast<std::uint32_t>(std::strlen(funcname_))),
+      format_offset_(0),
+      format_size_(0) {
+    const std::reverse_iterator<const char *> begin(filename_ + filename_size_);
+    const std::reverse_iterator<const char *> end(filename_);
+    const auto it =
+        std::find_first_of(begin, end, std::begin(os::folder_seps), std::end(os::folder_seps) - 1);
+    if (it != end) {
+        basename_offset_ = static_cast<std::uint32_t>(it.base() - filename_);
+    }
+
+    // the leading string literal of the arguments
+    const char *p = args_;
+    while (*p == ' ') {
+        p++;
+    }
+    if (*p == '"') {
+        const char *start = ++p;
+        while (*p != '\0' && *p != '"') {
+            p += (*p == '\\' && p[1] != '\0') ? 2 : 1;
+        }
+        if (*p == '"') {
+            format_offset_ = static_cast<std::uint32_t>(start - args_);
+            format_size_ = static_cast<std::uint32_t>(p - start);
+        }
+    }
+
+    id_ = call_site_registry::instance().add(this);
+}
+
+namespace {
+// the descriptor of the SPDLOG_LOGGER_CALL expansion Id (its __COUNTER__) of this translation unit.
+// a function rather than a static in the macro, so that the macro is an expression usable at any
+// scope.
+template <int Id>
+call_site &call_site_of(const char *filename, int line, const char *funcname, const char *args) {
+    static call_site site(filename, line, funcname, args);
+    return site;
+}
+}  // namespace
+
+// the call site of loc, nullptr if loc wasn't made by a call site
+inline const call_site *find_call_site(const source_loc &loc) {
+    return loc.site_id != 0 ? call_site_registry::instance().find(loc.site_id) : nullptr;
+}
+
+// file and function name of loc (which must not be empty), without strlen if it has a call site
+inline string_view_t source_filename(const source_loc &loc) {
+    auto *site = find_call_site(loc);
+    return site != nullptr ? site->filename() : string_view_t{loc.filename};
+}
+
+inline string_view_t source_funcname(const source_loc &loc) {
+    auto *site = find_call_site(loc);
+    if (site != nullptr) {
+        return site->funcname();
+    }
+    return loc.funcname != nullptr ? string_view_t{loc.funcname} : string_view_t{};
+}
+
+}  // namespace details
+}  // namespace spdlog
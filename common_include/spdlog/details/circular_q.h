@@ -50,6 +50,7 @@ public:
 
             if (tail_ == head_)  // overrun last item if full
             {
+                v_[head_] = T{};  // drop what the overrun item holds right away
                 head_ = (head_ + 1) % max_items_;
                 ++overrun_counter_;
             }
@@ -0,0 +1,259 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// Clock sources for log message timestamps (see clock_source in common.h).
+//
+// precise: os::now().
+// coarse:  CLOCK_REALTIME_COARSE on linux. Served from the vDSO without reading the hardware
+//          clock, at the cost of a resolution of one scheduler tick.
+// tsc:     the cpu time stamp counter (rdtsc), converted to log_clock time with a tick rate
+//          calibrated against log_clock. The calibration is resynced at most every
+//          resync_interval by the thread that notices it is due, so the timestamps follow
+//          adjustments of the wall clock. Falls back to precise on cpus without an invariant
+//          TSC and on other architectures.
+//
+// Header only (like call_site.h), whether or not spdlog is built as a compiled lib.
+
+#include <spdlog/common.h>
+#include <spdlog/details/os.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <mutex>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+    #define SPDLOG_HAS_TSC
+    #ifdef _MSC_VER
+        #include <intrin.h>
+    #else
+        #include <cpuid.h>
+        #include <x86intrin.h>
+    #endif
+#endif
+
+namespace spdlog {
+namespace details {
+
+class tsc_clock {
+public:
+    static tsc_clock &instance();
+
+    tsc_clock(const tsc_clock &) = delete;
+    tsc_clock &operator=(const tsc_clock &) = delete;
+
+    // false if the cpu has no invariant TSC. now() returns os::now() then.
+    bool available() const { return available_; }
+
+    static std::uint64_t ticks() SPDLOG_NOEXCEPT {
+#ifdef SPDLOG_HAS_TSC
+        return __rdtsc();
+#else
+        return 0;
+#endif
+    }
+
+    log_clock::time_point now() SPDLOG_NOEXCEPT;
+    log_clock::time_point to_time_point(std::uint64_t ticks) SPDLOG_NOEXCEPT;
+
+    // measured tick rate
+    double ticks_per_second() const SPDLOG_NOEXCEPT;
+
+    void set_resync_interval(std::chrono::milliseconds interval);
+
+private:
+    tsc_clock();
+    void resync_(std::uint64_t ticks) SPDLOG_NOEXCEPT;
+    static void sample_(std::uint64_t &ticks, std::int64_t &ns) SPDLOG_NOEXCEPT;
+    static std::int64_t wall_ns_() SPDLOG_NOEXCEPT;
+
+    bool available_;
+
+    // first calibration point. the tick rate is measured over [first, last resync].
+    std::uint64_t first_ticks_;
+    std::int64_t first_ns_;
+
+    // conversion base, written under a seqlock (odd seq_: resync in progress)
+    std::atomic<std::uint32_t> seq_{0};
+    std::atomic<std::uint64_t> base_ticks_{0};
+    std::atomic<std::int64_t> base_ns_{0};
+    std::atomic<double> ns_per_tick_{1.0};
+
+    std::atomic<std::uint64_t> resync_ticks_{0};
+    std::mutex resync_mutex_;
+};
+
+inline log_clock::time_point coarse_now() SPDLOG_NOEXCEPT {
+#if defined(__linux__) && defined(CLOCK_REALTIME_COARSE)
+    timespec ts;
+    ::clock_gettime(CLOCK_REALTIME_COARSE, &ts);
+    return log_clock::time_point(std::chrono::duration_cast<log_clock::duration>(
+        std::chrono::seconds(ts.tv_sec) + std::chrono::nanoseconds(ts.tv_nsec)));
+#else
+    return os::now();
+#endif
+}
+
+// current time from the given source
+inline log_clock::time_point clock_now(clock_source source) SPDLOG_NOEXCEPT {
+    switch (source) {
+        case clock_source::coarse:
+            return coarse_now();
+        case clock_source::tsc:
+            return tsc_clock::instance().now();
+        default:
+            return os::now();
+    }
+}
+
+inline tsc_clock &tsc_clock::instance() {
+    static tsc_clock s_instance;
+    return s_instance;
+}
+
+inline tsc_clock::tsc_clock()
+    : available_(false),
+      first_ticks_(0),
+      first_ns_(0) {
+#ifdef SPDLOG_HAS_TSC
+    // invariant TSC: constant rate in all power states (cpuid 0x80000007, edx bit 8)
+    #ifdef _MSC_VER
+    int regs[4];
+    __cpuid(regs, 0x80000000);
+    if (static_cast<unsigned>(regs[0]) >= 0x80000007u) {
+        __cpuid(regs, 0x80000007);
+        available_ = ((regs[3] >> 8) & 1) != 0;
+    }
+    #else
+    unsigned eax, ebx, ecx, edx;
+    if (__get_cpuid(0x80000007u, &eax, &ebx, &ecx, &edx)) {
+        available_ = ((edx >> 8) & 1) != 0;
+    }
+    #endif
+#endif
+    if (!available_) {
+        return;
+    }
+
+    // initial rate, measured over 2ms. the resyncs refine it over a longer period.
+    sample_(first_ticks_, first_ns_);
+    std::uint64_t t = 0;
+    std::int64_t ns = 0;
+    do {
+        sample_(t, ns);
+    } while (ns - first_ns_ < 2000000 && ns >= first_ns_);
+    auto rate = t > first_ticks_ && ns > first_ns_
+                    ? static_cast<double>(ns - first_ns_) / static_cast<double>(t - first_ticks_)
+                    : 1.0;
+    base_ticks_.store(t, std::memory_order_relaxed);
+    base_ns_.store(ns, std::memory_order_relaxed);
+    ns_per_tick_.store(rate, std::memory_order_relaxed);
+    set_resync_interval(std::chrono::seconds(1));
+}
+
+inline log_clock::time_point tsc_clock::now() SPDLOG_NOEXCEPT {
+    if (!available_) {
+        return os::now();
+    }
+    auto t = ticks();
+    if (t - base_ticks_.load(std::memory_order_relaxed) >
+        resync_ticks_.load(std::memory_order_relaxed)) {
+        resync_(t);
+    }
+    return to_time_point(t);
+}
+
+inline log_clock::time_point tsc_clock::to_time_point(std::uint64_t t) SPDLOG_NOEXCEPT {
+    std::uint64_t base_ticks;
+    std::int64_t base_ns;
+    double ns_per_tick;
+    for (;;) {
+        auto seq = seq_.load(std::memory_order_acquire);
+        base_ticks = base_ticks_.load(std::memory_order_relaxed);
+        base_ns = base_ns_.load(std::memory_order_relaxed);
+        ns_per_tick = ns_per_tick_.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if ((seq & 1) == 0 && seq_.load(std::memory_order_relaxed) == seq) {
+            break;
+        }
+    }
+
+    // ticks read before a concurrent resync may be a little older than the base
+    auto delta = t >= base_ticks ? static_cast<double>(t - base_ticks)
+                                 : -static_cast<double>(base_ticks - t);
+    auto ns = base_ns + static_cast<std::int64_t>(delta * ns_per_tick);
+    return log_clock::time_point(
+        std::chrono::duration_cast<log_clock::duration>(std::chrono::nanoseconds(ns)));
+}
+
+inline double tsc_clock::ticks_per_second() const SPDLOG_NOEXCEPT {
+    return 1e9 / ns_per_tick_.load(std::memory_order_relaxed);
+}
+
+inline void tsc_clock::set_resync_interval(std::chrono::milliseconds interval) {
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(interval).count();
+    auto rate = ns_per_tick_.load(std::memory_order_relaxed);
+    resync_ticks_.store(static_cast<std::uint64_t>(static_cast<double>(ns) / rate),
+                        std::memory_order_relaxed);
+}
+
+inline void tsc_clock::resync_(std::uint64_t t) SPDLOG_NOEXCEPT {
+    std::unique_lock<std::mutex> lock(resync_mutex_, std::try_to_lock);
+    if (!lock.owns_lock() || t - base_ticks_.load(std::memory_order_relaxed) <=
+                                 resync_ticks_.load(std::memory_order_relaxed)) {
+        return;  // another thread is doing it, or has just done it
+    }
+
+    std::int64_t ns = 0;
+    sample_(t, ns);
+    auto rate = ns_per_tick_.load(std::memory_order_relaxed);
+    if (ns > first_ns_ && t > first_ticks_) {
+        auto measured = static_cast<double>(ns - first_ns_) / static_cast<double>(t - first_ticks_);
+        if (measured > rate * 0.5 && measured < rate * 2) {
+            rate = measured;
+        } else {
+            // the wall clock was stepped: measure again from here
+            first_ticks_ = t;
+            first_ns_ = ns;
+        }
+    } else {
+        first_ticks_ = t;
+        first_ns_ = ns;
+    }
+
+    auto seq = seq_.load(std::memory_order_relaxed);
+    seq_.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    base_ticks_.store(t, std::memory_order_relaxed);
+    base_ns_.store(ns, std::memory_order_relaxed);
+    ns_per_tick_.store(rate, std::memory_order_relaxed);
+    seq_.store(seq + 2, std::memory_order_release);
+}
+
+// a (ticks, wall clock) pair. the wall clock is read between two tick reads, and the pair with
+// the shortest window of a few tries is kept, so that a preemption doesn't skew the pair.
+inline void tsc_clock::sample_(std::uint64_t &t, std::int64_t &ns) SPDLOG_NOEXCEPT {
+    std::uint64_t best_window = ~std::uint64_t(0);
+    for (int i = 0; i < 5; i++) {
+        auto before = ticks();
+        auto wall = wall_ns_();
+        auto after = ticks();
+        if (after - before < best_window) {
+            best_window = after - before;
+            t = before + best_window / 2;
+            ns = wall;
+        }
+    }
+}
+
+inline std::int64_t tsc_clock::wall_ns_() SPDLOG_NOEXCEPT {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               log_clock::now().time_since_epoch())
+        .count();
+}
+
+}  // namespace details
+}  // namespace spdlog
@@ -0,0 +1,216 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// Capture of log call arguments for formatting on another thread.
+//
+// encode_deferred(..) serializes the format string and the arguments into a flat buffer:
+//     [uint32 fmt size][fmt bytes][type][arg 0][type][arg 1]...
+// where type is a deferred_arg_type byte. Arithmetic and enum arguments are stored as raw bytes
+// (enums as their underlying integer). Strings (const char*, std::string, string views) are
+// copied as [uint32 size][bytes], so they don't need to outlive the call.
+// Any other argument type makes the call non deferrable and it is formatted as usual.
+// The type bytes make the buffer self describing, so it can also be stored as is (see
+// binary_file_sink) and decoded by a program that doesn't know the argument types.
+//
+// deferred_formatter<Args...>::format is generated at compile time for each argument list.
+// It decodes the buffer back into values of the same types (strings as string_view_t)
+// and runs them through the regular fmt formatting.
+
+#include <spdlog/common.h>
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+namespace spdlog {
+namespace details {
+
+enum class deferred_arg_type : unsigned char {
+    boolean = 1,
+    character,
+    int8,
+    int16,
+    int32,
+    int64,
+    uint8,
+    uint16,
+    uint32,
+    uint64,
+    float32,
+    float64,
+    float_long,  // long double, in the native representation
+    string
+};
+
+// format the deferred message stored in blob and append the result to dest
+using deferred_format_fn = void (*)(string_view_t blob, memory_buf_t &dest);
+
+inline void deferred_append(memory_buf_t &buf, const void *data, size_t size) {
+    auto *p = static_cast<const char *>(data);
+    buf.append(p, p + size);
+}
+
+inline string_view_t deferred_read_string(const char *&p) {
+    std::uint32_t size;
+    std::memcpy(&size, p, sizeof(size));
+    p += sizeof(size);
+    string_view_t s{p, size};
+    p += size;
+    return s;
+}
+
+inline void deferred_write_string(memory_buf_t &buf, const char *data, size_t size) {
+    auto size32 = static_cast<std::uint32_t>(size);
+    deferred_append(buf, &size32, sizeof(size32));
+    deferred_append(buf, data, size32);
+}
+
+inline void deferred_write_type(memory_buf_t &buf, deferred_arg_type type) {
+    buf.push_back(static_cast<char>(type));
+}
+
+template <typename T, bool IsEnum = std::is_enum<T>::value>
+struct deferred_integral_type {
+    using type = T;
+};
+
+template <typename T>
+struct deferred_integral_type<T, true> {
+    using type = typename std::underlying_type<T>::type;
+};
+
+// type byte of an arithmetic or enum value
+template <typename T>
+deferred_arg_type deferred_type_of() {
+    using I = typename deferred_integral_type<T>::type;
+    return std::is_same<I, bool>::value ? deferred_arg_type::boolean
+           : std::is_same<I, char>::value ? deferred_arg_type::character
+           : std::is_floating_point<I>::value
+               ? (sizeof(I) == 4   ? deferred_arg_type::float32
+                  : sizeof(I) == 8 ? deferred_arg_type::float64
+                                   : deferred_arg_type::float_long)
+           : std::is_signed<I>::value
+               ? (sizeof(I) == 1   ? deferred_arg_type::int8
+                  : sizeof(I) == 2 ? deferred_arg_type::int16
+                  : sizeof(I) == 4 ? deferred_arg_type::int32
+                                   : deferred_arg_type::int64)
+               : (sizeof(I) == 1   ? deferred_arg_type::uint8
+                  : sizeof(I) == 2 ? deferred_arg_type::uint16
+                  : sizeof(I) == 4 ? deferred_arg_type::uint32
+                                   : deferred_arg_type::uint64);
+}
+
+// values stored as raw bytes
+template <typename T>
+struct deferred_codec {
+    static const bool enabled = std::is_arithmetic<T>::value || std::is_enum<T>::value;
+
+    static void encode(memory_buf_t &buf, const T &value) {
+        deferred_write_type(buf, deferred_type_of<T>());
+        deferred_append(buf, &value, sizeof(T));
+    }
+
+    static T decode(const char *&p) {
+        T value;
+        std::memcpy(&value, p + 1, sizeof(T));
+        p += 1 + sizeof(T);
+        return value;
+    }
+};
+
+// strings are copied
+struct deferred_string_codec {
+    static const bool enabled = true;
+
+    static void encode(memory_buf_t &buf, const char *s) {
+        deferred_write_type(buf, deferred_arg_type::string);
+        deferred_write_string(buf, s, s != nullptr ? std::strlen(s) : 0);
+    }
+
+    template <typename S>
+    static void encode(memory_buf_t &buf, const S &s) {
+        deferred_write_type(buf, deferred_arg_type::string);
+        deferred_write_string(buf, s.data(), s.size());
+    }
+
+    static string_view_t decode(const char *&p) {
+        p += 1;
+        return deferred_read_string(p);
+    }
+};
+
+template <>
+struct deferred_codec<const char *> : deferred_string_codec {};
+
+template <>
+struct deferred_codec<char *> : deferred_string_codec {};
+
+template <typename Traits, typename Alloc>
+struct deferred_codec<std::basic_string<char, Traits, Alloc>> : deferred_string_codec {};
+
+template <>
+struct deferred_codec<fmt_lib::basic_string_view<char>> : deferred_string_codec {};
+
+#if !defined(SPDLOG_USE_STD_FORMAT) && defined(__cpp_lib_string_view)
+template <>
+struct deferred_codec<std::string_view> : deferred_string_codec {};
+#endif
+
+template <typename T>
+using deferred_codec_t = deferred_codec<typename std::decay<T>::type>;
+
+// true if all the argument types can be captured
+template <typename... Args>
+struct is_deferrable : std::true_type {};
+
+template <typename T, typename... Rest>
+struct is_deferrable<T, Rest...>
+    : std::integral_constant<bool,
+                             deferred_codec_t<T>::enabled && is_deferrable<Rest...>::value> {};
+
+template <typename... Args>
+void encode_deferred(memory_buf_t &buf, string_view_t fmt, const Args &...args) {
+    deferred_write_string(buf, fmt.data(), fmt.size());
+    int expand[] = {0, (deferred_codec_t<Args>::encode(buf, args), 0)...};
+    (void)expand;
+}
+
+// decode the arguments one by one, then format them all at once
+template <typename... Rest>
+struct deferred_decoder;
+
+template <>
+struct deferred_decoder<> {
+    template <typename... Decoded>
+    static void format(string_view_t fmt, const char *, memory_buf_t &dest, Decoded &...decoded) {
+#ifdef SPDLOG_USE_STD_FORMAT
+        fmt_lib::vformat_to(std::back_inserter(dest), fmt, fmt_lib::make_format_args(decoded...));
+#else
+        fmt::vformat_to(fmt::appender(dest), fmt, fmt::make_format_args(decoded...));
+#endif
+    }
+};
+
+template <typename T, typename... Rest>
+struct deferred_decoder<T, Rest...> {
+    template <typename... Decoded>
+    static void format(string_view_t fmt, const char *p, memory_buf_t &dest, Decoded &...decoded) {
+        auto value = deferred_codec_t<T>::decode(p);
+        deferred_decoder<Rest...>::format(fmt, p, dest, decoded..., value);
+    }
+};
+
+template <typename... Args>
+struct deferred_formatter {
+    static void format(string_view_t blob, memory_buf_t &dest) {
+        const char *p = blob.data();
+        auto fmt = deferred_read_string(p);
+        deferred_decoder<Args...>::format(fmt, p, dest);
+    }
+};
+
+}  // namespace details
+}  // namespace spdlog
@@ -0,0 +1,150 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#ifndef SPDLOG_HEADER_ONLY
+    #include <spdlog/details/direct_file_writer.h>
+#endif
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#ifdef __linux__
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+namespace spdlog {
+namespace details {
+
+#ifdef __linux__
+
+SPDLOG_INLINE std::unique_ptr<direct_file_writer> direct_file_writer::open(
+    const filename_t &filename, std::uint64_t offset, size_t buffer_size) {
+    int fd = ::open(filename.c_str(), O_RDWR | O_DIRECT | O_CLOEXEC);
+    if (fd < 0) {
+        return nullptr;
+    }
+    buffer_size = std::max<size_t>(buffer_size, 16 * block_size);
+    buffer_size = (buffer_size + block_size - 1) / block_size * block_size;
+    std::unique_ptr<direct_file_writer> writer(new direct_file_writer(fd, buffer_size));
+    if (!writer->buffer_) {
+        return nullptr;
+    }
+
+    // start at the block of offset, with its current content
+    writer->offset_ = offset / block_size * block_size;
+    writer->fill_ = static_cast<size_t>(offset - writer->offset_);
+    if (writer->fill_ > 0 &&
+        ::pread(fd, writer->buffer_.get(), block_size, static_cast<off_t>(writer->offset_)) <
+            static_cast<ssize_t>(writer->fill_)) {
+        writer->fill_ = 0;  // nothing to flush on destruction
+        return nullptr;
+    }
+    return writer;
+}
+
+SPDLOG_INLINE bool direct_file_writer::available(const filename_t &filename) {
+    int fd = ::open(filename.c_str(), O_RDONLY | O_DIRECT | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    ::close(fd);
+    return true;
+}
+
+SPDLOG_INLINE direct_file_writer::direct_file_writer(int fd, size_t buffer_size)
+    : fd_(fd),
+      buffer_size_(buffer_size) {
+    void *p = nullptr;
+    if (::posix_memalign(&p, block_size, buffer_size_) == 0) {
+        buffer_.reset(static_cast<char *>(p));
+    }
+}
+
+SPDLOG_INLINE direct_file_writer::~direct_file_writer() {
+    if (buffer_ && flush() == 0 && padded_) {
+        (void)::ftruncate(fd_, static_cast<off_t>(offset_ + fill_));
+    }
+    ::close(fd_);
+}
+
+SPDLOG_INLINE int direct_file_writer::write(const char *data, size_t size) {
+    while (size > 0) {
+        auto n = std::min(size, buffer_size_ - fill_);
+        std::memcpy(buffer_.get() + fill_, data, n);
+        fill_ += n;
+        data += n;
+        size -= n;
+        if (fill_ == buffer_size_) {
+            auto error = write_blocks_(buffer_size_);
+            if (error != 0) {
+                return error;
+            }
+            offset_ += buffer_size_;
+            fill_ = 0;
+        }
+    }
+    return 0;
+}
+
+SPDLOG_INLINE int direct_file_writer::flush() {
+    if (fill_ == 0) {
+        return 0;
+    }
+    // write the last block padded with zeros. the padding is cut off on destruction.
+    auto full = fill_ / block_size * block_size;
+    auto padded = (fill_ + block_size - 1) / block_size * block_size;
+    std::memset(buffer_.get() + fill_, 0, padded - fill_);
+    auto error = write_blocks_(padded);
+    if (error != 0) {
+        return error;
+    }
+    padded_ = padded_ || padded > fill_;
+
+    // keep the partial block, the next write goes on from it
+    std::memmove(buffer_.get(), buffer_.get() + full, fill_ - full);
+    offset_ += full;
+    fill_ -= full;
+    return 0;
+}
+
+SPDLOG_INLINE int direct_file_writer::write_blocks_(size_t size) {
+    size_t done = 0;
+    while (done < size) {
+        auto ret = ::pwrite(fd_, buffer_.get() + done, size - done,
+                            static_cast<off_t>(offset_ + done));
+        if (ret < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return errno;
+        }
+        if (ret == 0) {
+            return EIO;
+        }
+        done += static_cast<size_t>(ret);
+    }
+    return 0;
+}
+
+#else  // !__linux__
+
+SPDLOG_INLINE std::unique_ptr<direct_file_writer> direct_file_writer::open(const filename_t &,
+                                                                           std::uint64_t,
+                                                                           size_t) {
+    return nullptr;
+}
+
+SPDLOG_INLINE bool direct_file_writer::available(const filename_t &) { return false; }
+
+SPDLOG_INLINE direct_file_writer::~direct_file_writer() = default;
+SPDLOG_INLINE int direct_file_writer::write(const char *, size_t) { return ENOSYS; }
+SPDLOG_INLINE int direct_file_writer::flush() { return ENOSYS; }
+
+#endif
+
+}  // namespace details
+}  // namespace spdlog
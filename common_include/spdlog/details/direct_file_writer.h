@@ -0,0 +1,69 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// File writer that bypasses the page cache with O_DIRECT (see file_cache_mode::direct).
+//
+// O_DIRECT writes must be whole blocks at block aligned offsets from an aligned buffer. The data
+// is collected in an aligned buffer and written when the buffer is full. flush() writes the
+// partial last block padded with zeros and keeps it in the buffer (the next write completes it
+// and writes it again). The file is truncated to its real length once, when the writer is
+// destroyed, so until then it may end with up to a block of zeros.
+
+#include <spdlog/common.h>
+
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+
+namespace spdlog {
+namespace details {
+
+class SPDLOG_API direct_file_writer {
+public:
+    static const size_t block_size = 4096;
+
+    // writer appending to filename at offset. nullptr if O_DIRECT is not available
+    // (other platforms, or file systems without O_DIRECT support like tmpfs).
+    static std::unique_ptr<direct_file_writer> open(const filename_t &filename,
+                                                    std::uint64_t offset,
+                                                    size_t buffer_size);
+    // whether open() can succeed for filename (O_DIRECT supported by its file system)
+    static bool available(const filename_t &filename);
+
+    direct_file_writer(const direct_file_writer &) = delete;
+    direct_file_writer &operator=(const direct_file_writer &) = delete;
+
+    // flushes, cuts the padding off and closes the file
+    ~direct_file_writer();
+
+    // the following return 0 or an errno value
+
+    int write(const char *data, size_t size);
+    int flush();
+
+    std::uint64_t size() const { return offset_ + fill_; }
+
+private:
+    struct free_deleter {
+        void operator()(char *p) const { std::free(p); }
+    };
+
+    direct_file_writer(int fd, size_t buffer_size);
+    int write_blocks_(size_t size);
+
+    int fd_;
+    std::unique_ptr<char, free_deleter> buffer_;
+    size_t buffer_size_;
+    std::uint64_t offset_ = 0;  // file offset of the buffer (block aligned)
+    size_t fill_ = 0;           // bytes in the buffer
+    bool padded_ = false;       // the file may end with the padding of flush()
+};
+
+}  // namespace details
+}  // namespace spdlog
+
+#ifdef SPDLOG_HEADER_ONLY
+    #include "direct_file_writer-inl.h"
+#endif
@@ -0,0 +1,193 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// Escaping of log text for structured output (the %j and %q pattern flags).
+//
+// The text is scanned for bytes that need attention (quotes, backslashes, control chars and
+// non ASCII bytes), 16 bytes at a time with SSE2. Clean runs are appended to dest as is.
+// Non ASCII bytes are kept if they form valid UTF-8, and replaced by U+FFFD otherwise, so the
+// output is always valid UTF-8.
+
+#include <spdlog/common.h>
+#include <spdlog/details/fmt_helper.h>
+
+#include <cstddef>
+
+namespace spdlog {
+namespace details {
+
+// length of the valid UTF-8 sequence at p (whose first byte is >= 0x80), 0 if invalid
+inline size_t utf8_sequence_length(const char *p, const char *end) {
+    auto *s = reinterpret_cast<const unsigned char *>(p);
+    auto available = static_cast<size_t>(end - p);
+    size_t length;
+    if (s[0] >= 0xc2 && s[0] <= 0xdf) {
+        length = 2;
+    } else if ((s[0] & 0xf0) == 0xe0) {
+        length = 3;
+    } else if (s[0] >= 0xf0 && s[0] <= 0xf4) {
+        length = 4;
+    } else {
+        return 0;
+    }
+    if (available < length) {
+        return 0;
+    }
+    for (size_t i = 1; i < length; i++) {
+        if ((s[i] & 0xc0) != 0x80) {
+            return 0;
+        }
+    }
+    // overlong forms, surrogates and code points above U+10FFFF
+    if ((s[0] == 0xe0 && s[1] < 0xa0) || (s[0] == 0xed && s[1] >= 0xa0) ||
+        (s[0] == 0xf0 && s[1] < 0x90) || (s[0] == 0xf4 && s[1] >= 0x90)) {
+        return 0;
+    }
+    return length;
+}
+
+// length of the run at p that can be copied as is: printable ASCII without '"' and '\'.
+// in logfmt mode space and '=' end the run too (they require a quoted value).
+template <bool Logfmt>
+inline size_t escape_clean_run(const char *p, const char *end) {
+    const char *start = p;
+#ifdef SPDLOG_USE_SSE2
+    // signed compare: bytes >= 0x80 are negative, so they are below the limit too
+    const __m128i limit = _mm_set1_epi8(Logfmt ? 0x21 : 0x20);
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i equals = _mm_set1_epi8(Logfmt ? '=' : '"');
+    for (; end - p >= 16; p += 16) {
+        const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+        const __m128i special =
+            _mm_or_si128(_mm_or_si128(_mm_cmplt_epi8(x, limit), _mm_cmpeq_epi8(x, quote)),
+                         _mm_or_si128(_mm_cmpeq_epi8(x, backslash), _mm_cmpeq_epi8(x, equals)));
+        auto mask = static_cast<unsigned>(_mm_movemask_epi8(special));
+        if (mask != 0) {
+    #if defined(__GNUC__) || defined(__clang__)
+            return static_cast<size_t>(p - start) + static_cast<size_t>(__builtin_ctz(mask));
+    #else
+            break;  // let the scalar loop find it
+    #endif
+        }
+    }
+#endif
+    for (; p < end; ++p) {
+        auto c = static_cast<unsigned char>(*p);
+        if (c < (Logfmt ? 0x21 : 0x20) || c >= 0x80 || c == '"' || c == '\\' ||
+            (Logfmt && c == '=')) {
+            break;
+        }
+    }
+    return static_cast<size_t>(p - start);
+}
+
+// append s to dest as the content of a JSON string (without the surrounding quotes)
+inline void json_escape(string_view_t s, memory_buf_t &dest) {
+    static const char hex[] = "0123456789abcdef";
+    const char *p = s.data();
+    const char *end = p + s.size();
+    while (p < end) {
+        auto clean = escape_clean_run<false>(p, end);
+        dest.append(p, p + clean);
+        p += clean;
+        if (p == end) {
+            break;
+        }
+
+        auto c = static_cast<unsigned char>(*p);
+        if (c >= 0x80) {
+            auto length = utf8_sequence_length(p, end);
+            if (length != 0) {
+                dest.append(p, p + length);
+                p += length;
+            } else {
+                fmt_helper::append_string_view("\\ufffd", dest);
+                ++p;
+            }
+            continue;
+        }
+
+        dest.push_back('\\');
+        switch (c) {
+            case '"':
+            case '\\':
+                dest.push_back(static_cast<char>(c));
+                break;
+            case '\n':
+                dest.push_back('n');
+                break;
+            case '\r':
+                dest.push_back('r');
+                break;
+            case '\t':
+                dest.push_back('t');
+                break;
+            case '\b':
+                dest.push_back('b');
+                break;
+            case '\f':
+                dest.push_back('f');
+                break;
+            default:
+                fmt_helper::append_string_view("u00", dest);
+                dest.push_back(hex[c >> 4]);
+                dest.push_back(hex[c & 0xf]);
+                break;
+        }
+        ++p;
+    }
+}
+
+// true if s can't be written as a bare logfmt value
+inline bool logfmt_needs_quotes(string_view_t s) {
+    const char *p = s.data();
+    const char *end = p + s.size();
+    if (p == end) {
+        return true;
+    }
+    while (p < end) {
+        p += escape_clean_run<true>(p, end);
+        if (p == end) {
+            break;
+        }
+        if (static_cast<unsigned char>(*p) < 0x80) {
+            return true;
+        }
+        auto length = utf8_sequence_length(p, end);
+        if (length == 0) {
+            return true;
+        }
+        p += length;
+    }
+    return false;
+}
+
+// append s to dest as a logfmt value: as is if possible, otherwise quoted and escaped
+inline void logfmt_escape(string_view_t s, memory_buf_t &dest) {
+    if (!logfmt_needs_quotes(s)) {
+        fmt_helper::append_string_view(s, dest);
+        return;
+    }
+    dest.push_back('"');
+    json_escape(s, dest);
+    dest.push_back('"');
+}
+
+// append s to dest as a logfmt key. keys can't be quoted, so the bytes a key can't hold
+// (spaces, control characters, '=' and '"') are replaced with '_'. an empty key becomes "_".
+inline void logfmt_escape_key(string_view_t s, memory_buf_t &dest) {
+    if (s.size() == 0) {
+        dest.push_back('_');
+        return;
+    }
+    for (auto c : s) {
+        auto u = static_cast<unsigned char>(c);
+        dest.push_back(u <= ' ' || u == 0x7f || c == '=' || c == '"' ? '_' : c);
+    }
+}
+
+}  // namespace details
+}  // namespace spdlog
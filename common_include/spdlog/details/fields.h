@@ -0,0 +1,219 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// Structured fields of a log call (see kv() in common.h).
+//
+// The fields of a message are stored in log_msg::fields as one flat buffer:
+//     [uint32 key size][key bytes][type][value]...
+// where type and value use the tagged encoding of details/deferred_format.h.
+// Nothing is converted to text when logging. The buffer is copied as a whole with the message
+// (log_msg_buffer, async queue slots) and rendered by the %K and %J pattern flags.
+
+#include <spdlog/common.h>
+#include <spdlog/details/deferred_format.h>
+#include <spdlog/details/escape.h>
+#include <spdlog/details/fmt_helper.h>
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+
+namespace spdlog {
+namespace details {
+
+template <typename T>
+void encode_field(memory_buf_t &buf, const kv_field<T> &field) {
+    static_assert(deferred_codec_t<T>::enabled,
+                  "kv() values must be of arithmetic, enum or string type");
+    deferred_write_string(buf, field.key.data(), field.key.size());
+    deferred_codec_t<T>::encode(buf, field.value);
+}
+
+template <typename... Fields>
+void encode_fields(memory_buf_t &buf, const kv_field<Fields> &...fields) {
+    int expand[] = {0, (encode_field(buf, fields), 0)...};
+    (void)expand;
+}
+
+// a decoded field. value points to the raw value bytes (the chars for strings).
+struct field_view {
+    string_view_t key;
+    deferred_arg_type type;
+    const char *value;
+    size_t size;
+};
+
+// size of the raw value of the given type, 0 for strings and unknown types
+inline size_t field_value_size(deferred_arg_type type) {
+    switch (type) {
+        case deferred_arg_type::boolean:
+            return sizeof(bool);
+        case deferred_arg_type::character:
+        case deferred_arg_type::int8:
+        case deferred_arg_type::uint8:
+            return 1;
+        case deferred_arg_type::int16:
+        case deferred_arg_type::uint16:
+            return 2;
+        case deferred_arg_type::int32:
+        case deferred_arg_type::uint32:
+        case deferred_arg_type::float32:
+            return 4;
+        case deferred_arg_type::int64:
+        case deferred_arg_type::uint64:
+        case deferred_arg_type::float64:
+            return 8;
+        case deferred_arg_type::float_long:
+            return sizeof(long double);
+        default:
+            return 0;
+    }
+}
+
+// call f(const field_view &) for each field. stops at the first malformed field.
+template <typename F>
+void for_each_field(string_view_t fields, F &&f) {
+    const char *p = fields.data();
+    const char *end = p + fields.size();
+    while (static_cast<size_t>(end - p) > sizeof(std::uint32_t)) {
+        std::uint32_t key_size;
+        std::memcpy(&key_size, p, sizeof(key_size));
+        if (static_cast<size_t>(end - p) < sizeof(key_size) + key_size + 1) {
+            return;
+        }
+        field_view field;
+        field.key = deferred_read_string(p);
+        field.type = static_cast<deferred_arg_type>(*p++);
+        if (field.type == deferred_arg_type::string) {
+            std::uint32_t value_size = 0;
+            if (static_cast<size_t>(end - p) >= sizeof(value_size)) {
+                std::memcpy(&value_size, p, sizeof(value_size));
+            }
+            if (static_cast<size_t>(end - p) < sizeof(value_size) + value_size) {
+                return;
+            }
+            field.value = p + sizeof(value_size);
+            field.size = value_size;
+            p += sizeof(value_size) + value_size;
+        } else {
+            field.size = field_value_size(field.type);
+            if (field.size == 0 || static_cast<size_t>(end - p) < field.size) {
+                return;
+            }
+            field.value = p;
+            p += field.size;
+        }
+        f(field);
+    }
+}
+
+enum class field_style { logfmt, json };
+
+template <typename T>
+T field_read(const field_view &field) {
+    T value;
+    std::memcpy(&value, field.value, sizeof(T));
+    return value;
+}
+
+template <typename T>
+void append_field_float(T value, field_style style, memory_buf_t &dest) {
+    // json has no nan and inf
+    bool quote = style == field_style::json && !std::isfinite(value);
+    if (quote) {
+        dest.push_back('"');
+    }
+    fmt_lib::format_to(std::back_inserter(dest), SPDLOG_FMT_STRING("{}"), value);
+    if (quote) {
+        dest.push_back('"');
+    }
+}
+
+inline void append_field_text(string_view_t text, field_style style, memory_buf_t &dest) {
+    if (style == field_style::logfmt) {
+        logfmt_escape(text, dest);
+        return;
+    }
+    dest.push_back('"');
+    json_escape(text, dest);
+    dest.push_back('"');
+}
+
+inline void append_field_value(const field_view &field, field_style style, memory_buf_t &dest) {
+    switch (field.type) {
+        case deferred_arg_type::boolean:
+            fmt_helper::append_string_view(field_read<bool>(field) ? "true" : "false", dest);
+            break;
+        case deferred_arg_type::character:
+            append_field_text(string_view_t{field.value, 1}, style, dest);
+            break;
+        case deferred_arg_type::int8:
+            fmt_helper::append_int(static_cast<int>(field_read<std::int8_t>(field)), dest);
+            break;
+        case deferred_arg_type::int16:
+            fmt_helper::append_int(static_cast<int>(field_read<std::int16_t>(field)), dest);
+            break;
+        case deferred_arg_type::int32:
+            fmt_helper::append_int(field_read<std::int32_t>(field), dest);
+            break;
+        case deferred_arg_type::int64:
+            fmt_helper::append_int(field_read<std::int64_t>(field), dest);
+            break;
+        case deferred_arg_type::uint8:
+            fmt_helper::append_int(static_cast<unsigned>(field_read<std::uint8_t>(field)), dest);
+            break;
+        case deferred_arg_type::uint16:
+            fmt_helper::append_int(static_cast<unsigned>(field_read<std::uint16_t>(field)), dest);
+            break;
+        case deferred_arg_type::uint32:
+            fmt_helper::append_int(field_read<std::uint32_t>(field), dest);
+            break;
+        case deferred_arg_type::uint64:
+            fmt_helper::append_int(field_read<std::uint64_t>(field), dest);
+            break;
+        case deferred_arg_type::float32:
+            append_field_float(field_read<float>(field), style, dest);
+            break;
+        case deferred_arg_type::float64:
+            append_field_float(field_read<double>(field), style, dest);
+            break;
+        case deferred_arg_type::float_long:
+            append_field_float(field_read<long double>(field), style, dest);
+            break;
+        case deferred_arg_type::string:
+            append_field_text(string_view_t{field.value, field.size}, style, dest);
+            break;
+    }
+}
+
+// key=value pairs separated by spaces
+inline void append_fields_logfmt(string_view_t fields, memory_buf_t &dest) {
+    bool first = true;
+    for_each_field(fields, [&](const field_view &field) {
+        if (!first) {
+            dest.push_back(' ');
+        }
+        first = false;
+        logfmt_escape_key(field.key, dest);
+        dest.push_back('=');
+        append_field_value(field, field_style::logfmt, dest);
+    });
+}
+
+// ,"key":value for each field, to be placed after other members of a json object
+inline void append_fields_json(string_view_t fields, memory_buf_t &dest) {
+    for_each_field(fields, [&](const field_view &field) {
+        dest.push_back(',');
+        dest.push_back('"');
+        json_escape(field.key, dest);
+        dest.push_back('"');
+        dest.push_back(':');
+        append_field_value(field, field_style::json, dest);
+    });
+}
+
+}  // namespace details
+}  // namespace spdlog
@@ -12,14 +12,18 @@
 
 #include <cerrno>
 #include <cstdio>
+
+#ifdef __linux__
+    #include <fcntl.h>
+#endif
 #include <string>
 #include <tuple>
 
 namespace spdlog {
 namespace details {
 
-SPDLOG_INLINE file_helper::file_helper(const file_event_handlers &event_handlers)
-    : event_handlers_(event_handlers) {}
+SPDLOG_INLINE file_helper::file_helper(const file_options &options)
+    : options_(options) {}
 
 SPDLOG_INLINE file_helper::~file_helper() { close(); }
 
@@ -30,8 +34,8 @@ SPDLOG_INLINE void file_helper::open(const filename_t &fname, bool truncate) {
     auto *mode = SPDLOG_FILENAME_T("ab");
     auto *trunc_mode = SPDLOG_FILENAME_T("wb");
 
-    if (event_handlers_.before_open) {
-        event_handlers_.before_open(filename_);
+    if (options_.event_handlers.before_open) {
+        options_.event_handlers.before_open(filename_);
     }
     for (int tries = 0; tries < open_tries_; ++tries) {
         // create containing folder if not exists already.
@@ -48,8 +52,29 @@ SPDLOG_INLINE void file_helper::open(const filename_t &fname, bool truncate) {
             std::fclose(tmp);
         }
         if (!os::fopen_s(&fd_, fname, mode)) {
-            if (event_handlers_.after_open) {
-                event_handlers_.after_open(filename_, fd_);
+            // (setvbuf must come before any i/o, so check for O_DIRECT support beforehand)
+            const bool direct = !options_.io_uring &&
+                                options_.cache_mode == file_cache_mode::direct &&
+                                direct_file_writer::available(filename_);
+            if (options_.buffer_size > 0 && !options_.io_uring && !direct) {
+                if (!buffer_) {
+                    buffer_.reset(new char[options_.buffer_size]);
+                }
+                std::setvbuf(fd_, buffer_.get(), _IOFBF, options_.buffer_size);
+            }
+            if (options_.event_handlers.after_open) {
+                options_.event_handlers.after_open(filename_, fd_);
+            }
+            // continue after what after_open wrote
+            std::fflush(fd_);
+            written_ = started_ = dropped_ = os::filesize(fd_);
+            if (options_.io_uring) {
+                uring_ = io_uring_writer::open(filename_, written_, options_.io_uring_depth,
+                                               options_.io_uring_buffer_size);
+            } else if (direct) {
+                direct_ = direct_file_writer::open(
+                    filename_, written_,
+                    options_.buffer_size > 0 ? options_.buffer_size : 1024 * 1024);
             }
             return;
         }
@@ -69,12 +94,88 @@ SPDLOG_INLINE void file_helper::reopen(bool truncate) {
 }
 
 SPDLOG_INLINE void file_helper::flush() {
+    pending_bytes_ = 0;
+    if (uring_) {
+        auto error = uring_->flush(options_.io_uring_datasync);
+        if (error != 0) {
+            throw_spdlog_ex("Failed flush to file " + os::filename_to_str(filename_), error);
+        }
+        return;
+    }
+    if (direct_) {
+        auto error = direct_->flush();
+        if (error != 0) {
+            throw_spdlog_ex("Failed flush to file " + os::filename_to_str(filename_), error);
+        }
+        return;
+    }
     if (std::fflush(fd_) != 0) {
         throw_spdlog_ex("Failed flush to file " + os::filename_to_str(filename_), errno);
     }
+    if (options_.cache_mode == file_cache_mode::dontneed) {
+        drop_written_pages_();
+    }
+}
+
+SPDLOG_INLINE void file_helper::request_flush() {
+    if (flush_due_()) {
+        flush();
+    }
+}
+
+// hand each dontneed_chunk_ written to the disk without waiting for it (SYNC_FILE_RANGE_WRITE).
+// the previous one was handed to the disk a window ago: only wait for the end of its writeback
+// (WAIT_BEFORE doesn't start a new one) and drop it from the page cache. called after the stdio
+// buffer is flushed.
+SPDLOG_INLINE void file_helper::drop_written_pages_() {
+#ifdef __linux__
+    if (written_ - started_ < dontneed_chunk_) {
+        return;
+    }
+    int fd = ::fileno(fd_);
+    ::sync_file_range(fd, static_cast<off_t>(started_), static_cast<off_t>(written_ - started_),
+                      SYNC_FILE_RANGE_WRITE);
+    if (started_ > dropped_) {
+        auto length = static_cast<off_t>(started_ - dropped_);
+        ::sync_file_range(fd, static_cast<off_t>(dropped_), length, SYNC_FILE_RANGE_WAIT_BEFORE);
+        ::posix_fadvise(fd, static_cast<off_t>(dropped_), length, POSIX_FADV_DONTNEED);
+        dropped_ = started_;
+    }
+    started_ = written_;
+#endif
+}
+
+SPDLOG_INLINE bool file_helper::has_flush_policy_() const {
+    return options_.flush_bytes > 0 || options_.flush_interval.count() > 0;
+}
+
+SPDLOG_INLINE bool file_helper::flush_due_() const {
+    if (!has_flush_policy_()) {
+        return true;
+    }
+    if (pending_bytes_ == 0) {
+        return false;
+    }
+    if (options_.flush_bytes > 0 && pending_bytes_ >= options_.flush_bytes) {
+        return true;
+    }
+    return options_.flush_interval.count() > 0 &&
+           std::chrono::steady_clock::now() - pending_since_ >= options_.flush_interval;
 }
 
 SPDLOG_INLINE void file_helper::sync() {
+    if (uring_) {
+        auto error = uring_->drain();
+        if (error != 0) {
+            throw_spdlog_ex("Failed writing to file " + os::filename_to_str(filename_), error);
+        }
+    }
+    if (direct_) {
+        auto error = direct_->flush();
+        if (error != 0) {
+            throw_spdlog_ex("Failed flush to file " + os::filename_to_str(filename_), error);
+        }
+    }
     if (!os::fsync(fd_)) {
         throw_spdlog_ex("Failed to fsync file " + os::filename_to_str(filename_), errno);
     }
@@ -82,15 +183,20 @@ SPDLOG_INLINE void file_helper::sync() {
 
 SPDLOG_INLINE void file_helper::close() {
     if (fd_ != nullptr) {
-        if (event_handlers_.before_close) {
-            event_handlers_.before_close(filename_, fd_);
+        // waits for the writes in flight
+        uring_.reset();
+        direct_.reset();
+        pending_bytes_ = 0;
+
+        if (options_.event_handlers.before_close) {
+            options_.event_handlers.before_close(filename_, fd_);
         }
 
         std::fclose(fd_);
         fd_ = nullptr;
 
-        if (event_handlers_.after_close) {
-            event_handlers_.after_close(filename_);
+        if (options_.event_handlers.after_close) {
+            options_.event_handlers.after_close(filename_);
         }
     }
 }
@@ -100,20 +206,50 @@ SPDLOG_INLINE void file_helper::write(const memory_buf_t &buf) {
     size_t msg_size = buf.size();
     auto data = buf.data();
 
-    if (!details::os::fwrite_bytes(data, msg_size, fd_)) {
+    if (uring_ || direct_) {
+        auto error = uring_ ? uring_->write(data, msg_size) : direct_->write(data, msg_size);
+        if (error != 0) {
+            throw_spdlog_ex("Failed writing to file " + os::filename_to_str(filename_), error);
+        }
+    } else if (!details::os::fwrite_bytes(data, msg_size, fd_)) {
         throw_spdlog_ex("Failed writing to file " + os::filename_to_str(filename_), errno);
     }
+
+    written_ += msg_size;
+    if (options_.cache_mode == file_cache_mode::dontneed && !uring_ &&
+        written_ - started_ >= 2 * dontneed_chunk_) {
+        // don't let the page cache grow between flushes
+        flush();
+    }
+
+    if (has_flush_policy_()) {
+        if (pending_bytes_ == 0 && options_.flush_interval.count() > 0) {
+            pending_since_ = std::chrono::steady_clock::now();
+        }
+        pending_bytes_ += msg_size;
+        if (flush_due_()) {
+            flush();
+        }
+    }
 }
 
 SPDLOG_INLINE size_t file_helper::size() const {
     if (fd_ == nullptr) {
         throw_spdlog_ex("Cannot use size() on closed file " + os::filename_to_str(filename_));
     }
+    if (uring_) {
+        return static_cast<size_t>(uring_->size());
+    }
+    if (direct_) {
+        return static_cast<size_t>(direct_->size());
+    }
     return os::filesize(fd_);
 }
 
 SPDLOG_INLINE const filename_t &file_helper::filename() const { return filename_; }
 
+SPDLOG_INLINE void file_helper::renamed(const filename_t &fname) { filename_ = fname; }
+
 //
 // return file path and its extension:
 //
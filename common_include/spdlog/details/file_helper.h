@@ -4,6 +4,11 @@
 #pragma once
 
 #include <spdlog/common.h>
+#include <spdlog/details/direct_file_writer.h>
+#include <spdlog/details/io_uring_writer.h>
+
+#include <chrono>
+#include <memory>
 #include <tuple>
 
 namespace spdlog {
@@ -12,11 +17,15 @@ namespace details {
 // Helper class for file sinks.
 // When failing to open a file, retry several times(5) with a delay interval(10 ms).
 // Throw spdlog_ex exception on errors.
+// Writes through io_uring instead of stdio if file_options::io_uring is set, or with O_DIRECT
+// if file_options::cache_mode is direct.
+// With a flush policy in the file_options, write() and request_flush() flush only when the
+// policy is due; flush() always flushes.
 
 class SPDLOG_API file_helper {
 public:
     file_helper() = default;
-    explicit file_helper(const file_event_handlers &event_handlers);
+    explicit file_helper(const file_options &options);
 
     file_helper(const file_helper &) = delete;
     file_helper &operator=(const file_helper &) = delete;
@@ -25,11 +34,15 @@ public:
     void open(const filename_t &fname, bool truncate = false);
     void reopen(bool truncate);
     void flush();
+    // flush() if due by the flush policy (always without a policy)
+    void request_flush();
     void sync();
     void close();
     void write(const memory_buf_t &buf);
     size_t size() const;
     const filename_t &filename() const;
+    // the file was renamed by someone else: use the new name from now on
+    void renamed(const filename_t &fname);
 
     //
     // return file path and its extension:
@@ -47,11 +60,32 @@ public:
     static std::tuple<filename_t, filename_t> split_by_extension(const filename_t &fname);
 
 private:
+    bool has_flush_policy_() const;
+    bool flush_due_() const;
+    void drop_written_pages_();
+
+    static const size_t dontneed_chunk_ = 1024 * 1024;
     const int open_tries_ = 5;
     const unsigned int open_interval_ = 10;
     std::FILE *fd_{nullptr};
     filename_t filename_;
-    file_event_handlers event_handlers_;
+    file_options options_;
+    // set when writing through io_uring (file_options::io_uring)
+    std::unique_ptr<io_uring_writer> uring_;
+    // set when writing with O_DIRECT (file_cache_mode::direct)
+    std::unique_ptr<direct_file_writer> direct_;
+    // stdio buffer of file_options::buffer_size bytes
+    std::unique_ptr<char[]> buffer_;
+
+    // data written since the last flush (for the flush policy)
+    size_t pending_bytes_ = 0;
+    std::chrono::steady_clock::time_point pending_since_;
+
+    // file_cache_mode::dontneed: end of the data written, of the data handed to the disk, and
+    // of the data dropped from the page cache
+    std::uint64_t written_ = 0;
+    std::uint64_t started_ = 0;
+    std::uint64_t dropped_ = 0;
 };
 }  // namespace details
 }  // namespace spdlog
@@ -3,11 +3,19 @@
 #pragma once
 
 #include <chrono>
+#include <cstdint>
+#include <cstring>
 #include <iterator>
 #include <spdlog/common.h>
 #include <spdlog/fmt/fmt.h>
 #include <type_traits>
 
+#if !defined(SPDLOG_NO_SIMD) && \
+    (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+    #include <emmintrin.h>
+    #define SPDLOG_USE_SSE2
+#endif
+
 #ifdef SPDLOG_USE_STD_FORMAT
     #include <charconv>
     #include <limits>
@@ -81,11 +89,59 @@ inline unsigned int count_digits(T n) {
 #endif
 }
 
+// the two digits of n (0-99)
+inline const char *digits2(unsigned n) {
+    return &"0001020304050607080910111213141516171819"
+            "2021222324252627282930313233343536373839"
+            "4041424344454647484950515253545556575859"
+            "6061626364656667686970717273747576777879"
+            "8081828384858687888990919293949596979899"[n * 2];
+}
+
+#ifdef SPDLOG_USE_SSE2
+// write the 8 digits of n (< 100000000, zero padded) to out, all digits at once.
+// n is split into two 4 digit halves, each half is broadcast to 4 lanes and divided by
+// 1000, 100, 10 and 1 with multiply-high and shift, then the tens are subtracted.
+inline void write8digits(std::uint32_t n, char *out) {
+    const __m128i div10000 = _mm_set1_epi32(static_cast<int>(0xd1b71759));
+    const __m128i ten_thousand = _mm_set1_epi32(10000);
+    const __m128i div_powers = _mm_setr_epi16(8389, 5243, 13108, -32768, 8389, 5243, 13108, -32768);
+    const __m128i shift_powers = _mm_setr_epi16(1 << (16 - (23 + 2 - 16)), 1 << (16 - (19 + 2 - 16)),
+                                                1 << (16 - 1 - 2), -32768, 1 << (16 - (23 + 2 - 16)),
+                                                1 << (16 - (19 + 2 - 16)), 1 << (16 - 1 - 2), -32768);
+
+    // abcd, efgh = abcdefgh divmod 10000
+    const __m128i abcdefgh = _mm_cvtsi32_si128(static_cast<int>(n));
+    const __m128i abcd = _mm_srli_epi64(_mm_mul_epu32(abcdefgh, div10000), 45);
+    const __m128i efgh = _mm_sub_epi32(abcdefgh, _mm_mul_epu32(abcd, ten_thousand));
+    // [abcd * 4] x 4, [efgh * 4] x 4
+    const __m128i v1 = _mm_slli_epi64(_mm_unpacklo_epi16(abcd, efgh), 2);
+    const __m128i v2a = _mm_unpacklo_epi16(v1, v1);
+    const __m128i v2 = _mm_unpacklo_epi32(v2a, v2a);
+    // [a, ab, abc, abcd, e, ef, efg, efgh]
+    const __m128i v4 = _mm_mulhi_epu16(_mm_mulhi_epu16(v2, div_powers), shift_powers);
+    // [a, b, c, d, e, f, g, h]
+    const __m128i v5 = _mm_mullo_epi16(v4, _mm_set1_epi16(10));
+    const __m128i digits = _mm_sub_epi16(v4, _mm_slli_epi64(v5, 16));
+    const __m128i ascii =
+        _mm_add_epi8(_mm_packus_epi16(digits, _mm_setzero_si128()), _mm_set1_epi8('0'));
+    _mm_storel_epi64(reinterpret_cast<__m128i *>(out), ascii);
+}
+#else
+inline void write8digits(std::uint32_t n, char *out) {
+    for (int i = 6; i >= 0; i -= 2) {
+        std::memcpy(out + i, digits2(n % 100), 2);
+        n /= 100;
+    }
+}
+#endif
+
 inline void pad2(int n, memory_buf_t &dest) {
     if (n >= 0 && n < 100)  // 0-99
     {
-        dest.push_back(static_cast<char>('0' + n / 10));
-        dest.push_back(static_cast<char>('0' + n % 10));
+        auto *digits = digits2(static_cast<unsigned>(n));
+        dest.push_back(digits[0]);
+        dest.push_back(digits[1]);
     } else  // unlikely, but just in case, let fmt deal with it
     {
         fmt_lib::format_to(std::back_inserter(dest), SPDLOG_FMT_STRING("{:02}"), n);
@@ -105,10 +161,10 @@ template <typename T>
 inline void pad3(T n, memory_buf_t &dest) {
     static_assert(std::is_unsigned<T>::value, "pad3 must get unsigned T");
     if (n < 1000) {
-        dest.push_back(static_cast<char>(n / 100 + '0'));
-        n = n % 100;
-        dest.push_back(static_cast<char>((n / 10) + '0'));
-        dest.push_back(static_cast<char>((n % 10) + '0'));
+        char buf[3];
+        buf[0] = static_cast<char>(n / 100 + '0');
+        std::memcpy(buf + 1, digits2(static_cast<unsigned>(n % 100)), 2);
+        dest.append(buf, buf + 3);
     } else {
         append_int(n, dest);
     }
@@ -116,12 +172,27 @@ inline void pad3(T n, memory_buf_t &dest) {
 
 template <typename T>
 inline void pad6(T n, memory_buf_t &dest) {
-    pad_uint(n, 6, dest);
+    static_assert(std::is_unsigned<T>::value, "pad6 must get unsigned T");
+    if (n < 1000000) {
+        char buf[8];
+        write8digits(static_cast<std::uint32_t>(n), buf);
+        dest.append(buf + 2, buf + 8);
+    } else {
+        append_int(n, dest);
+    }
 }
 
 template <typename T>
 inline void pad9(T n, memory_buf_t &dest) {
-    pad_uint(n, 9, dest);
+    static_assert(std::is_unsigned<T>::value, "pad9 must get unsigned T");
+    if (n < 1000000000) {
+        char buf[9];
+        buf[0] = static_cast<char>(n / 100000000 + '0');
+        write8digits(static_cast<std::uint32_t>(n % 100000000), buf + 1);
+        dest.append(buf, buf + 9);
+    } else {
+        append_int(n, dest);
+    }
 }
 
 // return fraction of a second of the given time_point.
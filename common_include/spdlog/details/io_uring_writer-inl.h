@@ -0,0 +1,326 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#ifndef SPDLOG_HEADER_ONLY
+    #include <spdlog/details/io_uring_writer.h>
+#endif
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#ifdef SPDLOG_HAS_IO_URING
+    #include <fcntl.h>
+    #include <linux/io_uring.h>
+    #include <sys/mman.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
+#endif
+
+namespace spdlog {
+namespace details {
+
+#ifdef SPDLOG_HAS_IO_URING
+
+// user_data of the fdatasync requests. the writes carry their buffer index.
+static const std::uint64_t io_uring_sync_tag = ~std::uint64_t(0);
+
+SPDLOG_INLINE std::unique_ptr<io_uring_writer> io_uring_writer::open(const filename_t &filename,
+                                                                     std::uint64_t offset,
+                                                                     size_t depth,
+                                                                     size_t buffer_size) {
+    depth = std::max<size_t>(depth, 1);
+    buffer_size = std::max<size_t>(buffer_size, 4096);
+    int fd = ::open(filename.c_str(), O_WRONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return nullptr;
+    }
+    std::unique_ptr<io_uring_writer> writer(new io_uring_writer(fd, offset, depth, buffer_size));
+    // room for a write per buffer and as many fdatasync requests
+    if (!writer->setup_(static_cast<unsigned>(depth * 2))) {
+        return nullptr;
+    }
+    return writer;
+}
+
+SPDLOG_INLINE io_uring_writer::io_uring_writer(int fd,
+                                               std::uint64_t offset,
+                                               size_t depth,
+                                               size_t buffer_size)
+    : fd_(fd),
+      buffers_(depth),
+      buffer_size_(buffer_size),
+      offset_(offset) {
+    for (auto &buf : buffers_) {
+        buf.data.reset(new char[buffer_size_]);
+    }
+}
+
+SPDLOG_INLINE io_uring_writer::~io_uring_writer() {
+    if (cqes_ != nullptr) {
+        drain();
+    }
+    if (sqes_ != nullptr) {
+        ::munmap(sqes_, sqes_size_);
+    }
+    if (cq_ring_ != nullptr && cq_ring_ != sq_ring_) {
+        ::munmap(cq_ring_, cq_ring_size_);
+    }
+    if (sq_ring_ != nullptr) {
+        ::munmap(sq_ring_, sq_ring_size_);
+    }
+    if (ring_fd_ >= 0) {
+        ::close(ring_fd_);
+    }
+    ::close(fd_);
+}
+
+SPDLOG_INLINE bool io_uring_writer::setup_(unsigned entries) {
+    io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+    ring_fd_ = static_cast<int>(::syscall(__NR_io_uring_setup, entries, &params));
+    // IORING_OP_WRITE came with IORING_FEAT_RW_CUR_POS (linux 5.6)
+    if (ring_fd_ < 0 || (params.features & IORING_FEAT_RW_CUR_POS) == 0) {
+        return false;
+    }
+    sq_entries_ = params.sq_entries;
+
+    sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    const bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single_mmap) {
+        sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+    }
+    auto *sq_ring = ::mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE,
+                           MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQ_RING);
+    if (sq_ring == MAP_FAILED) {
+        return false;
+    }
+    sq_ring_ = sq_ring;
+    if (single_mmap) {
+        cq_ring_ = sq_ring_;
+    } else {
+        auto *cq_ring = ::mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE,
+                               MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_CQ_RING);
+        if (cq_ring == MAP_FAILED) {
+            return false;
+        }
+        cq_ring_ = cq_ring;
+    }
+    sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+    auto *sqes = ::mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                        ring_fd_, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) {
+        return false;
+    }
+    sqes_ = static_cast<io_uring_sqe *>(sqes);
+
+    auto *sq = static_cast<char *>(sq_ring_);
+    auto *cq = static_cast<char *>(cq_ring_);
+    sq_tail_ = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+    sq_mask_ = reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+    sq_array_ = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+    cq_head_ = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+    cq_tail_ = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+    cq_mask_ = reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+    return true;
+}
+
+SPDLOG_INLINE int io_uring_writer::write(const char *data, size_t size) {
+    reap_();
+    while (size > 0) {
+        // wait for the next buffer if it is still being written
+        while (buffers_[current_].in_flight) {
+            if (!wait_()) {
+                return take_error_();
+            }
+        }
+        auto n = std::min(size, buffer_size_ - fill_);
+        std::memcpy(buffers_[current_].data.get() + fill_, data, n);
+        fill_ += n;
+        data += n;
+        size -= n;
+        if (fill_ == buffer_size_) {
+            submit_current_();
+        }
+    }
+    return take_error_();
+}
+
+SPDLOG_INLINE int io_uring_writer::flush(bool datasync) {
+    reap_();
+    if (fill_ > 0) {
+        submit_current_();
+    }
+    if (datasync) {
+        submit_datasync_();
+    }
+    return take_error_();
+}
+
+SPDLOG_INLINE int io_uring_writer::drain() {
+    if (fill_ > 0) {
+        submit_current_();
+    }
+    while (in_flight_ > 0 && wait_()) {
+    }
+    return take_error_();
+}
+
+SPDLOG_INLINE void io_uring_writer::submit_current_() {
+    auto &buf = buffers_[current_];
+    buf.size = fill_;
+    buf.done = 0;
+    buf.offset = offset_;
+    offset_ += fill_;
+    fill_ = 0;
+    submit_write_(current_);
+    current_ = (current_ + 1) % buffers_.size();
+}
+
+SPDLOG_INLINE void io_uring_writer::submit_write_(size_t index) {
+    auto &buf = buffers_[index];
+    auto *sqe = get_sqe_();
+    sqe->opcode = IORING_OP_WRITE;
+    sqe->fd = fd_;
+    sqe->off = buf.offset + buf.done;
+    sqe->addr = reinterpret_cast<std::uintptr_t>(buf.data.get() + buf.done);
+    sqe->len = static_cast<std::uint32_t>(buf.size - buf.done);
+    sqe->user_data = index;
+    buf.in_flight = true;
+    submit_sqe_();
+}
+
+// the fdatasync starts after the writes submitted before it (IOSQE_IO_DRAIN)
+SPDLOG_INLINE void io_uring_writer::submit_datasync_() {
+    auto *sqe = get_sqe_();
+    sqe->opcode = IORING_OP_FSYNC;
+    sqe->flags = IOSQE_IO_DRAIN;
+    sqe->fd = fd_;
+    sqe->fsync_flags = IORING_FSYNC_DATASYNC;
+    sqe->user_data = io_uring_sync_tag;
+    submit_sqe_();
+}
+
+// a cleared sqe. waits for a completion if the ring is full.
+SPDLOG_INLINE io_uring_sqe *io_uring_writer::get_sqe_() {
+    while (in_flight_ >= sq_entries_ && wait_()) {
+    }
+    auto *sqe = &sqes_[*sq_tail_ & *sq_mask_];
+    std::memset(sqe, 0, sizeof(*sqe));
+    return sqe;
+}
+
+SPDLOG_INLINE void io_uring_writer::submit_sqe_() {
+    auto tail = *sq_tail_;
+    auto index = tail & *sq_mask_;
+    sq_array_[index] = index;
+    __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+    in_flight_++;
+    unsubmitted_++;
+    enter_(0);
+}
+
+// submit the pending sqes and wait for min_complete completions.
+// returns false (and sets error_) if io_uring_enter fails.
+SPDLOG_INLINE bool io_uring_writer::enter_(unsigned min_complete) {
+    const unsigned flags = min_complete > 0 ? IORING_ENTER_GETEVENTS : 0;
+    for (;;) {
+        auto ret = ::syscall(__NR_io_uring_enter, ring_fd_, unsubmitted_, min_complete, flags,
+                             nullptr, 0);
+        if (ret >= 0) {
+            unsubmitted_ -= std::min(unsubmitted_, static_cast<unsigned>(ret));
+            return true;
+        }
+        if (errno != EINTR) {
+            if (error_ == 0) {
+                error_ = errno;
+            }
+            return false;
+        }
+    }
+}
+
+SPDLOG_INLINE bool io_uring_writer::wait_() {
+    if (!enter_(1)) {
+        return false;
+    }
+    reap_();
+    return true;
+}
+
+// the short writes are resubmitted after the completion queue loop: submitting may wait for
+// completions and reap them, which must not happen while head is held here.
+SPDLOG_INLINE void io_uring_writer::reap_() {
+    bool resubmit = false;
+    auto head = *cq_head_;
+    auto tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+    while (head != tail) {
+        const auto &cqe = cqes_[head & *cq_mask_];
+        const auto user_data = cqe.user_data;
+        const auto res = cqe.res;
+        __atomic_store_n(cq_head_, ++head, __ATOMIC_RELEASE);
+        in_flight_--;
+
+        if (user_data == io_uring_sync_tag) {
+            if (res < 0 && error_ == 0) {
+                error_ = -res;
+            }
+            continue;
+        }
+        auto &buf = buffers_[user_data];
+        if (res <= 0) {
+            // the data of the buffer is lost
+            if (error_ == 0) {
+                error_ = res < 0 ? -res : EIO;
+            }
+            buf.in_flight = false;
+            continue;
+        }
+        buf.done += static_cast<size_t>(res);
+        if (buf.done < buf.size) {
+            buf.resubmit = true;  // short write: submit the rest below
+            resubmit = true;
+        } else {
+            buf.in_flight = false;
+        }
+    }
+
+    if (!resubmit) {
+        return;
+    }
+    for (size_t i = 0; i < buffers_.size(); i++) {
+        if (buffers_[i].resubmit) {
+            buffers_[i].resubmit = false;
+            submit_write_(i);
+        }
+    }
+}
+
+SPDLOG_INLINE int io_uring_writer::take_error_() {
+    auto error = error_;
+    error_ = 0;
+    return error;
+}
+
+#else  // !SPDLOG_HAS_IO_URING
+
+SPDLOG_INLINE std::unique_ptr<io_uring_writer> io_uring_writer::open(const filename_t &,
+                                                                     std::uint64_t,
+                                                                     size_t,
+                                                                     size_t) {
+    return nullptr;
+}
+
+SPDLOG_INLINE io_uring_writer::~io_uring_writer() = default;
+SPDLOG_INLINE int io_uring_writer::write(const char *, size_t) { return ENOSYS; }
+SPDLOG_INLINE int io_uring_writer::flush(bool) { return ENOSYS; }
+SPDLOG_INLINE int io_uring_writer::drain() { return ENOSYS; }
+
+#endif
+
+}  // namespace details
+}  // namespace spdlog
@@ -0,0 +1,116 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// File writer that submits its writes through io_uring (see file_options::io_uring).
+//
+// The data is copied into a fixed set of buffers. A buffer is submitted when it is full, or by
+// flush(), and is reused once its write completes, so the caller only waits for the disk when all
+// the buffers are in flight. Completions are reaped by the next call: a failed write is reported
+// by the return value of the next write(), flush() or drain().
+//
+// The writes go to explicit offsets of a separate descriptor opened without O_APPEND, so buffers
+// that complete out of order still land in place.
+
+#include <spdlog/common.h>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#if defined(__linux__) && defined(__has_include)
+    #if __has_include(<linux/io_uring.h>)
+        #define SPDLOG_HAS_IO_URING
+    #endif
+#endif
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+namespace spdlog {
+namespace details {
+
+class SPDLOG_API io_uring_writer {
+public:
+    // writer appending to filename at offset. nullptr if io_uring is not available
+    // (other platforms, kernels older than 5.6, or io_uring disabled by the system).
+    static std::unique_ptr<io_uring_writer> open(const filename_t &filename,
+                                                 std::uint64_t offset,
+                                                 size_t depth,
+                                                 size_t buffer_size);
+
+    io_uring_writer(const io_uring_writer &) = delete;
+    io_uring_writer &operator=(const io_uring_writer &) = delete;
+
+    // waits for the writes in flight
+    ~io_uring_writer();
+
+    // the following return 0, or the errno of a failed write since the previous call
+
+    int write(const char *data, size_t size);
+    // submit the buffered data (followed by an fdatasync if datasync is set) without waiting
+    int flush(bool datasync);
+    // submit the buffered data and wait until all the writes complete
+    int drain();
+
+    // size of the file once all the data is written
+    std::uint64_t size() const { return offset_ + fill_; }
+
+private:
+    struct buffer {
+        std::unique_ptr<char[]> data;
+        size_t size = 0;  // bytes submitted
+        size_t done = 0;  // bytes written so far
+        std::uint64_t offset = 0;
+        bool in_flight = false;
+        bool resubmit = false;  // short write, the rest is submitted at the end of reap_()
+    };
+
+    io_uring_writer(int fd, std::uint64_t offset, size_t depth, size_t buffer_size);
+    bool setup_(unsigned entries);
+
+    void submit_current_();
+    void submit_write_(size_t index);
+    void submit_datasync_();
+    io_uring_sqe *get_sqe_();
+    void submit_sqe_();
+    bool enter_(unsigned min_complete);
+    bool wait_();
+    void reap_();
+    int take_error_();
+
+    int fd_;
+    int ring_fd_ = -1;
+
+    void *sq_ring_ = nullptr;
+    void *cq_ring_ = nullptr;
+    size_t sq_ring_size_ = 0;
+    size_t cq_ring_size_ = 0;
+    io_uring_sqe *sqes_ = nullptr;
+    size_t sqes_size_ = 0;
+    unsigned *sq_tail_ = nullptr;
+    unsigned *sq_mask_ = nullptr;
+    unsigned *sq_array_ = nullptr;
+    unsigned *cq_head_ = nullptr;
+    unsigned *cq_tail_ = nullptr;
+    unsigned *cq_mask_ = nullptr;
+    io_uring_cqe *cqes_ = nullptr;
+    unsigned sq_entries_ = 0;
+
+    std::vector<buffer> buffers_;
+    size_t buffer_size_;
+    size_t current_ = 0;        // buffer being filled
+    size_t fill_ = 0;           // bytes in the current buffer
+    std::uint64_t offset_;      // offset of the current buffer
+    unsigned in_flight_ = 0;    // queued operations not completed yet
+    unsigned unsubmitted_ = 0;  // queued operations not passed to the kernel yet
+    int error_ = 0;
+};
+
+}  // namespace details
+}  // namespace spdlog
+
+#ifdef SPDLOG_HEADER_ONLY
+    #include "io_uring_writer-inl.h"
+#endif
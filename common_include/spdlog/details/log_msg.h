@@ -31,6 +31,13 @@ struct SPDLOG_API log_msg {
 
     source_loc source;
     string_view_t payload;
+
+    // captured format string and arguments of a deferred log call, in the layout of
+    // details/deferred_format.h. empty if the message was formatted by the caller.
+    string_view_t deferred_args;
+
+    // structured fields of the call (kv()), in the layout of details/fields.h. empty if none.
+    string_view_t fields;
 };
 }  // namespace details
 }  // namespace spdlog
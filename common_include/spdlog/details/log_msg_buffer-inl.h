@@ -14,6 +14,8 @@ SPDLOG_INLINE log_msg_buffer::log_msg_buffer(const log_msg &orig_msg)
     : log_msg{orig_msg} {
     buffer.append(logger_name.begin(), logger_name.end());
     buffer.append(payload.begin(), payload.end());
+    buffer.append(deferred_args.begin(), deferred_args.end());
+    buffer.append(fields.begin(), fields.end());
     update_string_views();
 }
 
@@ -21,6 +23,8 @@ SPDLOG_INLINE log_msg_buffer::log_msg_buffer(const log_msg_buffer &other)
     : log_msg{other} {
     buffer.append(logger_name.begin(), logger_name.end());
     buffer.append(payload.begin(), payload.end());
+    buffer.append(deferred_args.begin(), deferred_args.end());
+    buffer.append(fields.begin(), fields.end());
     update_string_views();
 }
 
@@ -48,6 +52,8 @@ SPDLOG_INLINE log_msg_buffer &log_msg_buffer::operator=(log_msg_buffer &&other)
 SPDLOG_INLINE void log_msg_buffer::update_string_views() {
     logger_name = string_view_t{buffer.data(), logger_name.size()};
     payload = string_view_t{buffer.data() + logger_name.size(), payload.size()};
+    deferred_args = string_view_t{payload.data() + payload.size(), deferred_args.size()};
+    fields = string_view_t{deferred_args.data() + deferred_args.size(), fields.size()};
 }
 
 }  // namespace details
@@ -0,0 +1,209 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#ifndef SPDLOG_HEADER_ONLY
+    #include <spdlog/details/mmap_file.h>
+#endif
+
+#include <spdlog/details/os.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#ifndef _WIN32
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace spdlog {
+namespace details {
+
+SPDLOG_INLINE mmap_file::mmap_file(const mmap_file_options &options)
+    : options_(options) {
+#ifndef _WIN32
+    page_size_ = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+#endif
+    auto chunk = std::max(options_.chunk_size, page_size_);
+    options_.chunk_size = (chunk + page_size_ - 1) / page_size_ * page_size_;
+}
+
+SPDLOG_INLINE mmap_file::~mmap_file() { close(); }
+
+#ifndef _WIN32
+
+SPDLOG_INLINE void mmap_file::open(const filename_t &fname, bool truncate) {
+    close();
+    filename_ = fname;
+    os::create_dir(os::dir_name(fname));
+    int flags = O_RDWR | O_CREAT | O_CLOEXEC | (truncate ? O_TRUNC : 0);
+    fd_ = ::open(fname.c_str(), flags, 0644);
+    if (fd_ < 0) {
+        throw_spdlog_ex("Failed opening file " + os::filename_to_str(filename_) + " for writing",
+                        errno);
+    }
+
+    struct stat st;
+    if (::fstat(fd_, &st) != 0) {
+        auto error = errno;
+        close();
+        throw_spdlog_ex("Failed getting size of file " + os::filename_to_str(fname), error);
+    }
+    pos_ = static_cast<std::uint64_t>(st.st_size);
+    dirty_ = pos_;
+    unmapped_dirty_ = false;
+
+    // skip the zeros preallocated by a previous run that didn't close the file
+    // (less than a chunk, so a mapping of the last chunk_size bytes is enough)
+    if (pos_ > 0) {
+        auto chunk = options_.chunk_size;
+        map_chunk_(pos_ > chunk ? (pos_ - chunk + page_size_ - 1) / page_size_ * page_size_ : 0);
+        while (pos_ > map_offset_ && map_[pos_ - map_offset_ - 1] == '\0') {
+            pos_--;
+        }
+        dirty_ = pos_;
+    }
+    map_chunk_(pos_ / page_size_ * page_size_);
+}
+
+SPDLOG_INLINE void mmap_file::write(const char *data, size_t size) {
+    if (fd_ < 0) return;
+    while (size > 0) {
+        auto map_end = map_offset_ + options_.chunk_size;
+        if (pos_ == map_end) {
+            map_chunk_(map_end);
+            continue;
+        }
+        auto n = static_cast<size_t>(std::min<std::uint64_t>(size, map_end - pos_));
+        std::memcpy(map_ + (pos_ - map_offset_), data, n);
+        pos_ += n;
+        data += n;
+        size -= n;
+    }
+}
+
+SPDLOG_INLINE void mmap_file::flush() {
+    if (fd_ < 0 || options_.sync == mmap_sync_policy::none) {
+        return;
+    }
+    if (!sync_dirty_(options_.sync == mmap_sync_policy::sync ? MS_SYNC : MS_ASYNC)) {
+        throw_spdlog_ex("Failed to sync file " + os::filename_to_str(filename_), errno);
+    }
+    if (unmapped_dirty_ && options_.sync == mmap_sync_policy::sync) {
+        if (::fdatasync(fd_) != 0) {
+            throw_spdlog_ex("Failed to fsync file " + os::filename_to_str(filename_), errno);
+        }
+        unmapped_dirty_ = false;
+    }
+}
+
+SPDLOG_INLINE void mmap_file::close() {
+    if (fd_ < 0) {
+        return;
+    }
+    unmap_chunk_();
+    // drop the preallocated tail
+    (void)::ftruncate(fd_, static_cast<off_t>(pos_));
+    ::close(fd_);
+    fd_ = -1;
+}
+
+// map chunk_size bytes from offset (a multiple of the page size), allocating them in the file
+SPDLOG_INLINE void mmap_file::map_chunk_(std::uint64_t offset) {
+    unmap_chunk_();
+    auto end = offset + options_.chunk_size;
+    struct stat st;
+    if (::fstat(fd_, &st) == 0 && static_cast<std::uint64_t>(st.st_size) < end) {
+        // reserve the blocks, so that running out of disk space fails here and not with a
+        // SIGBUS when writing to the mapping. a sparse ftruncate() would not reserve them.
+        auto from = std::max(offset, static_cast<std::uint64_t>(st.st_size));
+    #ifdef __linux__
+        bool ok = ::fallocate(fd_, 0, static_cast<off_t>(offset),
+                              static_cast<off_t>(options_.chunk_size)) == 0;
+        if (!ok && (errno == EOPNOTSUPP || errno == ENOSYS)) {
+            ok = zero_fill_(from, end);
+        }
+    #else
+        bool ok = zero_fill_(from, end);
+    #endif
+        if (!ok) {
+            throw_spdlog_ex("Failed allocating space in file " + os::filename_to_str(filename_),
+                            errno);
+        }
+    }
+
+    auto *map = ::mmap(nullptr, options_.chunk_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd_,
+                       static_cast<off_t>(offset));
+    if (map == MAP_FAILED) {
+        throw_spdlog_ex("Failed mapping file " + os::filename_to_str(filename_), errno);
+    }
+    map_ = static_cast<char *>(map);
+    map_offset_ = offset;
+    dirty_ = std::max(dirty_, offset);
+}
+
+SPDLOG_INLINE bool mmap_file::zero_fill_(std::uint64_t from, std::uint64_t to) {
+    static const char zeros[64 * 1024] = {};
+    while (from < to) {
+        auto n = static_cast<size_t>(std::min<std::uint64_t>(to - from, sizeof(zeros)));
+        auto ret = ::pwrite(fd_, zeros, n, static_cast<off_t>(from));
+        if (ret < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        if (ret == 0) {
+            errno = ENOSPC;
+            return false;
+        }
+        from += static_cast<std::uint64_t>(ret);
+    }
+    return true;
+}
+
+SPDLOG_INLINE void mmap_file::unmap_chunk_() {
+    if (map_ == nullptr) {
+        return;
+    }
+    if (options_.sync != mmap_sync_policy::none && pos_ > dirty_) {
+        // start writing back what the next flush() must sync
+        (void)sync_dirty_(MS_ASYNC);
+        unmapped_dirty_ = true;
+    }
+    ::munmap(map_, options_.chunk_size);
+    map_ = nullptr;
+}
+
+// msync the data written since the previous sync. returns false (with errno set) on failure.
+SPDLOG_INLINE bool mmap_file::sync_dirty_(int flags) {
+    if (map_ == nullptr || pos_ <= dirty_) {
+        return true;
+    }
+    auto begin = dirty_ / page_size_ * page_size_;
+    if (::msync(map_ + (begin - map_offset_), static_cast<size_t>(pos_ - begin), flags) != 0) {
+        return false;
+    }
+    dirty_ = pos_;
+    return true;
+}
+
+#else  // _WIN32
+
+SPDLOG_INLINE void mmap_file::open(const filename_t &fname, bool) {
+    filename_ = fname;
+    throw_spdlog_ex("mmap_file_sink is not supported on this platform");
+}
+
+SPDLOG_INLINE void mmap_file::write(const char *, size_t) {}
+SPDLOG_INLINE void mmap_file::flush() {}
+SPDLOG_INLINE void mmap_file::close() {}
+
+#endif
+
+}  // namespace details
+}  // namespace spdlog
@@ -0,0 +1,80 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// Append-only file written through a memory mapping (see sinks/mmap_file_sink.h).
+//
+// The file is extended with fallocate by chunk_size bytes at a time and the current chunk is
+// mapped, so a write is a memcpy into the mapping. Only moving to the next chunk makes system
+// calls. On close the mapping is released and the file is truncated to the written length.
+//
+// The data is in the page cache as soon as it is copied, so it survives a crash of the process
+// (like the data that basic_file_sink has flushed). A crash leaves the preallocated tail of the
+// file filled with zeros; reopening the file without truncating it continues after the last
+// non-zero byte. Surviving a crash of the system requires mmap_sync_policy::sync and a flush.
+//
+// POSIX only.
+
+#include <spdlog/common.h>
+
+#include <cstdint>
+
+namespace spdlog {
+
+// what flush() does with the data written since the previous flush
+enum class mmap_sync_policy {
+    none,   // nothing. the kernel writes it back in its own time
+    async,  // start writing it back (msync MS_ASYNC)
+    sync    // write it back and wait (msync MS_SYNC)
+};
+
+struct mmap_file_options {
+    // the file grows, and the mapping moves, by this much (rounded up to pages)
+    size_t chunk_size = 16 * 1024 * 1024;
+    mmap_sync_policy sync = mmap_sync_policy::none;
+};
+
+namespace details {
+
+class SPDLOG_API mmap_file {
+public:
+    explicit mmap_file(const mmap_file_options &options);
+
+    mmap_file(const mmap_file &) = delete;
+    mmap_file &operator=(const mmap_file &) = delete;
+    ~mmap_file();
+
+    void open(const filename_t &fname, bool truncate = false);
+    void write(const char *data, size_t size);
+    void flush();
+    void close();
+    // written length
+    size_t size() const { return static_cast<size_t>(pos_); }
+    const filename_t &filename() const { return filename_; }
+
+private:
+    void map_chunk_(std::uint64_t offset);
+    void unmap_chunk_();
+    // write zeros over [from, to), for file systems without fallocate. returns false on error.
+    bool zero_fill_(std::uint64_t from, std::uint64_t to);
+    bool sync_dirty_(int flags);
+
+    mmap_file_options options_;
+    filename_t filename_;
+    int fd_ = -1;
+    size_t page_size_ = 4096;
+
+    char *map_ = nullptr;
+    std::uint64_t map_offset_ = 0;  // file offset of the mapping
+    std::uint64_t pos_ = 0;         // file offset of the next write
+    std::uint64_t dirty_ = 0;       // file offset of the data not synced yet (in the mapping)
+    bool unmapped_dirty_ = false;   // data not synced yet in a previous mapping
+};
+
+}  // namespace details
+}  // namespace spdlog
+
+#ifdef SPDLOG_HEADER_ONLY
+    #include "mmap_file-inl.h"
+#endif
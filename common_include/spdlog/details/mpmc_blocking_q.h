@@ -7,10 +7,18 @@
 // enqueue(..) - will block until room found to put the new message.
 // enqueue_nowait(..) - will return immediately with false if no room left in
 // the queue.
+// try_enqueue(..) - will return false if no room left in the queue.
 // dequeue_for(..) - will block until the queue is not empty or timeout have
 // passed.
+// dequeue_bulk(..) - will block until the queue is not empty and then pop up to
+// max_items items under a single lock.
+// dequeue_bulk_for(..) - same as dequeue_bulk(..), but gives up after a timeout.
+//
+// Blocked threads follow the given wait_strategy. They spin on an unlocked copy of the queue
+// size and take the lock only when the queue looks ready, or when they park.
 
 #include <spdlog/details/circular_q.h>
+#include <spdlog/details/wait_strategy.h>
 
 #include <atomic>
 #include <condition_variable>
@@ -23,16 +31,19 @@ template <typename T>
 class mpmc_blocking_queue {
 public:
     using item_type = T;
-    explicit mpmc_blocking_queue(size_t max_items)
-        : q_(max_items) {}
+    explicit mpmc_blocking_queue(size_t max_items, const wait_strategy &strategy = {})
+        : max_items_(max_items),
+          strategy_(strategy),
+          q_(max_items) {}
 
 #ifndef __MINGW32__
     // try to enqueue and block if no room left
     void enqueue(T &&item) {
         {
             std::unique_lock<std::mutex> lock(queue_mutex_);
-            pop_cv_.wait(lock, [this] { return !this->q_.full(); });
+            wait_for_room_(lock);
             q_.push_back(std::move(item));
+            update_size_();
         }
         push_cv_.notify_one();
     }
@@ -42,6 +53,7 @@ public:
         {
             std::unique_lock<std::mutex> lock(queue_mutex_);
             q_.push_back(std::move(item));
+            update_size_();
         }
         push_cv_.notify_one();
     }
@@ -52,6 +64,7 @@ public:
             std::unique_lock<std::mutex> lock(queue_mutex_);
             if (!q_.full()) {
                 q_.push_back(std::move(item));
+                update_size_();
                 pushed = true;
             }
         }
@@ -63,16 +76,31 @@ public:
         }
     }
 
+    // enqueue if there is room. Return false (with item untouched) if the queue is full.
+    bool try_enqueue(T &&item) {
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex_);
+            if (q_.full()) {
+                return false;
+            }
+            q_.push_back(std::move(item));
+            update_size_();
+        }
+        push_cv_.notify_one();
+        return true;
+    }
+
     // dequeue with a timeout.
     // Return true, if succeeded dequeue item, false otherwise
     bool dequeue_for(T &popped_item, std::chrono::milliseconds wait_duration) {
         {
             std::unique_lock<std::mutex> lock(queue_mutex_);
-            if (!push_cv_.wait_for(lock, wait_duration, [this] { return !this->q_.empty(); })) {
+            if (!wait_for_items_(lock, std::chrono::steady_clock::now() + wait_duration)) {
                 return false;
             }
             popped_item = std::move(q_.front());
             q_.pop_front();
+            update_size_();
         }
         pop_cv_.notify_one();
         return true;
@@ -82,13 +110,51 @@ public:
     void dequeue(T &popped_item) {
         {
             std::unique_lock<std::mutex> lock(queue_mutex_);
-            push_cv_.wait(lock, [this] { return !this->q_.empty(); });
+            wait_for_items_(lock, wait_forever());
             popped_item = std::move(q_.front());
             q_.pop_front();
+            update_size_();
         }
         pop_cv_.notify_one();
     }
 
+    // blocking dequeue of up to max_items items without a timeout.
+    // Return the number of items stored in popped_items.
+    size_t dequeue_bulk(T *popped_items, size_t max_items) {
+        size_t n = 0;
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex_);
+            wait_for_items_(lock, wait_forever());
+            for (; n < max_items && !q_.empty(); n++) {
+                popped_items[n] = std::move(q_.front());
+                q_.pop_front();
+            }
+            update_size_();
+        }
+        pop_cv_.notify_all();
+        return n;
+    }
+
+    // same as dequeue_bulk(), but return 0 if the queue stays empty for wait_duration.
+    size_t dequeue_bulk_for(T *popped_items,
+                            size_t max_items,
+                            std::chrono::milliseconds wait_duration) {
+        size_t n = 0;
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex_);
+            if (!wait_for_items_(lock, std::chrono::steady_clock::now() + wait_duration)) {
+                return 0;
+            }
+            for (; n < max_items && !q_.empty(); n++) {
+                popped_items[n] = std::move(q_.front());
+                q_.pop_front();
+            }
+            update_size_();
+        }
+        pop_cv_.notify_all();
+        return n;
+    }
+
 #else
     // apparently mingw deadlocks if the mutex is released before cv.notify_one(),
     // so release the mutex at the very end each function.
@@ -96,8 +162,9 @@ public:
     // try to enqueue and block if no room left
     void enqueue(T &&item) {
         std::unique_lock<std::mutex> lock(queue_mutex_);
-        pop_cv_.wait(lock, [this] { return !this->q_.full(); });
+        wait_for_room_(lock);
         q_.push_back(std::move(item));
+        update_size_();
         push_cv_.notify_one();
     }
 
@@ -105,6 +172,7 @@ public:
     void enqueue_nowait(T &&item) {
         std::unique_lock<std::mutex> lock(queue_mutex_);
         q_.push_back(std::move(item));
+        update_size_();
         push_cv_.notify_one();
     }
 
@@ -113,6 +181,7 @@ public:
         std::unique_lock<std::mutex> lock(queue_mutex_);
         if (!q_.full()) {
             q_.push_back(std::move(item));
+            update_size_();
             pushed = true;
         }
 
@@ -123,15 +192,28 @@ public:
         }
     }
 
+    // enqueue if there is room. Return false (with item untouched) if the queue is full.
+    bool try_enqueue(T &&item) {
+        std::unique_lock<std::mutex> lock(queue_mutex_);
+        if (q_.full()) {
+            return false;
+        }
+        q_.push_back(std::move(item));
+        update_size_();
+        push_cv_.notify_one();
+        return true;
+    }
+
     // dequeue with a timeout.
     // Return true, if succeeded dequeue item, false otherwise
     bool dequeue_for(T &popped_item, std::chrono::milliseconds wait_duration) {
         std::unique_lock<std::mutex> lock(queue_mutex_);
-        if (!push_cv_.wait_for(lock, wait_duration, [this] { return !this->q_.empty(); })) {
+        if (!wait_for_items_(lock, std::chrono::steady_clock::now() + wait_duration)) {
             return false;
         }
         popped_item = std::move(q_.front());
         q_.pop_front();
+        update_size_();
         pop_cv_.notify_one();
         return true;
     }
@@ -139,12 +221,46 @@ public:
     // blocking dequeue without a timeout.
     void dequeue(T &popped_item) {
         std::unique_lock<std::mutex> lock(queue_mutex_);
-        push_cv_.wait(lock, [this] { return !this->q_.empty(); });
+        wait_for_items_(lock, wait_forever());
         popped_item = std::move(q_.front());
         q_.pop_front();
+        update_size_();
         pop_cv_.notify_one();
     }
 
+    // blocking dequeue of up to max_items items without a timeout.
+    // Return the number of items stored in popped_items.
+    size_t dequeue_bulk(T *popped_items, size_t max_items) {
+        std::unique_lock<std::mutex> lock(queue_mutex_);
+        wait_for_items_(lock, wait_forever());
+        size_t n = 0;
+        for (; n < max_items && !q_.empty(); n++) {
+            popped_items[n] = std::move(q_.front());
+            q_.pop_front();
+        }
+        update_size_();
+        pop_cv_.notify_all();
+        return n;
+    }
+
+    // same as dequeue_bulk(), but return 0 if the queue stays empty for wait_duration.
+    size_t dequeue_bulk_for(T *popped_items,
+                            size_t max_items,
+                            std::chrono::milliseconds wait_duration) {
+        std::unique_lock<std::mutex> lock(queue_mutex_);
+        if (!wait_for_items_(lock, std::chrono::steady_clock::now() + wait_duration)) {
+            return 0;
+        }
+        size_t n = 0;
+        for (; n < max_items && !q_.empty(); n++) {
+            popped_items[n] = std::move(q_.front());
+            q_.pop_front();
+        }
+        update_size_();
+        pop_cv_.notify_all();
+        return n;
+    }
+
 #endif
 
     size_t overrun_counter() {
@@ -167,11 +283,59 @@ public:
     void reset_discard_counter() { discard_counter_.store(0, std::memory_order_relaxed); }
 
 private:
+    // must be called under the lock after every change of q_
+    void update_size_() { size_.store(q_.size(), std::memory_order_relaxed); }
+
+    void wait_for_room_(std::unique_lock<std::mutex> &lock) {
+        wait_(
+            lock, pop_cv_,
+            [this] { return this->size_.load(std::memory_order_relaxed) < this->max_items_; },
+            [this] { return !this->q_.full(); }, wait_forever());
+    }
+
+    bool wait_for_items_(std::unique_lock<std::mutex> &lock,
+                         std::chrono::steady_clock::time_point deadline) {
+        return wait_(
+            lock, push_cv_, [this] { return this->size_.load(std::memory_order_relaxed) != 0; },
+            [this] { return !this->q_.empty(); }, deadline);
+    }
+
+    // wait until ready() holds. the lock is held on entry and on return, and released while
+    // spinning on looks_ready(), which doesn't need it.
+    // return false if the deadline passed first.
+    template <typename LooksReady, typename Ready>
+    bool wait_(std::unique_lock<std::mutex> &lock,
+               std::condition_variable &cv,
+               LooksReady looks_ready,
+               Ready ready,
+               std::chrono::steady_clock::time_point deadline) {
+        while (!ready()) {
+            lock.unlock();
+            bool looked_ready = spin_wait(strategy_, looks_ready, deadline);
+            lock.lock();
+            if (looked_ready) {
+                continue;  // another thread may have been faster
+            }
+            if (strategy_.mode != wait_mode::park) {
+                return ready();
+            }
+            if (deadline == wait_forever()) {
+                cv.wait(lock, ready);
+                return true;
+            }
+            return cv.wait_until(lock, deadline, ready);
+        }
+        return true;
+    }
+
+    const size_t max_items_;
+    const wait_strategy strategy_;
     std::mutex queue_mutex_;
     std::condition_variable push_cv_;
     std::condition_variable pop_cv_;
     spdlog::details::circular_q<T> q_;
     std::atomic<size_t> discard_counter_{0};
+    std::atomic<size_t> size_{0};
 };
 }  // namespace details
 }  // namespace spdlog
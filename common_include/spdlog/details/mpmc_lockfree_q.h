@@ -0,0 +1,264 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// bounded lock-free queue (multi producer, multi consumer safe).
+// Drop-in alternative to mpmc_blocking_queue for the async thread pool.
+//
+// Based on Dmitry Vyukov's bounded queue: every slot carries a sequence number
+// telling whether it is ready to be written (seq == pos) or read (seq == pos + 1).
+// Producers and consumers claim a position with a compare-and-swap only once its slot is
+// ready, so nobody ever owns a position it has to wait for.
+// enqueue(..) - will block until a slot is free.
+// enqueue_nowait(..) - never blocks. overruns the oldest message if no room left.
+// enqueue_if_have_room(..) - never blocks. discards the new message if no room left.
+// try_enqueue(..) - never blocks. returns false if no room left.
+// dequeue_for(..) - will block until the queue is not empty or timeout have
+// passed.
+// dequeue_bulk(..) - will block until the queue is not empty and then pop up to
+// max_items items.
+// dequeue_bulk_for(..) - same as dequeue_bulk(..), but gives up after a timeout.
+//
+// Waiting threads follow the given wait_strategy: by default they spin for a short while
+// and then park on a condition variable. The mutex is only touched when some thread is
+// actually parked, so the fast path of both producers and consumers is lock free.
+
+#include <spdlog/common.h>
+#include <spdlog/details/wait_strategy.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace spdlog {
+namespace details {
+
+SPDLOG_CONSTEXPR static const size_t cache_line_size = 64;
+
+template <typename T>
+class mpmc_lockfree_queue {
+public:
+    using item_type = T;
+
+    explicit mpmc_lockfree_queue(size_t max_items, const wait_strategy &strategy = {})
+        : max_items_(max_items > 0 ? max_items : 1),
+          strategy_(strategy),
+          slots_(new slot[max_items_]) {
+        for (size_t i = 0; i < max_items_; i++) {
+            slots_[i].seq.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    mpmc_lockfree_queue(const mpmc_lockfree_queue &) = delete;
+    mpmc_lockfree_queue &operator=(const mpmc_lockfree_queue &) = delete;
+
+    // try to enqueue and block if no room left
+    void enqueue(T &&item) {
+        if (!try_enqueue_(item)) {
+            wait_(pop_cv_, waiting_producers_, [this, &item] { return try_enqueue_(item); });
+        }
+        notify_(push_cv_, waiting_consumers_);
+    }
+
+    // enqueue immediately. overrun oldest message in the queue if no room left.
+    void enqueue_nowait(T &&item) {
+        while (!try_enqueue_(item)) {
+            T discarded;
+            if (try_dequeue_(discarded)) {
+                overrun_counter_.fetch_add(1, std::memory_order_relaxed);
+                notify_(pop_cv_, waiting_producers_);
+            }
+        }
+        notify_(push_cv_, waiting_consumers_);
+    }
+
+    void enqueue_if_have_room(T &&item) {
+        if (try_enqueue_(item)) {
+            notify_(push_cv_, waiting_consumers_);
+        } else {
+            discard_counter_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    // enqueue if there is room. Return false (with item untouched) if the queue is full.
+    bool try_enqueue(T &&item) {
+        if (!try_enqueue_(item)) {
+            return false;
+        }
+        notify_(push_cv_, waiting_consumers_);
+        return true;
+    }
+
+    // dequeue with a timeout.
+    // Return true, if succeeded dequeue item, false otherwise
+    bool dequeue_for(T &popped_item, std::chrono::milliseconds wait_duration) {
+        if (!try_dequeue_(popped_item)) {
+            bool popped = wait_for_(push_cv_, waiting_consumers_, wait_duration,
+                                    [this, &popped_item] { return try_dequeue_(popped_item); });
+            if (!popped) {
+                return false;
+            }
+        }
+        notify_(pop_cv_, waiting_producers_);
+        return true;
+    }
+
+    // blocking dequeue without a timeout.
+    void dequeue(T &popped_item) {
+        if (!try_dequeue_(popped_item)) {
+            wait_(push_cv_, waiting_consumers_,
+                  [this, &popped_item] { return try_dequeue_(popped_item); });
+        }
+        notify_(pop_cv_, waiting_producers_);
+    }
+
+    // blocking dequeue of up to max_items items without a timeout.
+    // Return the number of items stored in popped_items.
+    size_t dequeue_bulk(T *popped_items, size_t max_items) {
+        if (max_items == 0) {
+            return 0;
+        }
+        dequeue(popped_items[0]);
+        return 1 + dequeue_more_(popped_items + 1, max_items - 1);
+    }
+
+    // same as dequeue_bulk(), but return 0 if the queue stays empty for wait_duration.
+    size_t dequeue_bulk_for(T *popped_items,
+                            size_t max_items,
+                            std::chrono::milliseconds wait_duration) {
+        if (max_items == 0 || !dequeue_for(popped_items[0], wait_duration)) {
+            return 0;
+        }
+        return 1 + dequeue_more_(popped_items + 1, max_items - 1);
+    }
+
+    size_t overrun_counter() { return overrun_counter_.load(std::memory_order_relaxed); }
+
+    size_t discard_counter() { return discard_counter_.load(std::memory_order_relaxed); }
+
+    // approximate number of items in the queue.
+    size_t size() {
+        auto tail = dequeue_pos_.load(std::memory_order_relaxed);
+        auto head = enqueue_pos_.load(std::memory_order_relaxed);
+        auto n = head > tail ? head - tail : 0;
+        return n < max_items_ ? n : max_items_;
+    }
+
+    void reset_overrun_counter() { overrun_counter_.store(0, std::memory_order_relaxed); }
+
+    void reset_discard_counter() { discard_counter_.store(0, std::memory_order_relaxed); }
+
+private:
+    // one cache line (or more) per slot, so that neighbouring slots don't false-share
+    struct alignas(cache_line_size) slot {
+        std::atomic<size_t> seq{0};
+        T item;
+    };
+
+    // claim the next slot only if it is free. the item is moved only on success.
+    bool try_enqueue_(T &item) {
+        auto pos = enqueue_pos_.load(std::memory_order_relaxed);
+        for (;;) {
+            auto &s = slots_[pos % max_items_];
+            auto seq = s.seq.load(std::memory_order_acquire);
+            if (seq == pos) {
+                if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    s.item = std::move(item);
+                    s.seq.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (seq < pos) {
+                return false;  // full
+            } else {
+                pos = enqueue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool try_dequeue_(T &popped_item) {
+        auto pos = dequeue_pos_.load(std::memory_order_relaxed);
+        for (;;) {
+            auto &s = slots_[pos % max_items_];
+            auto seq = s.seq.load(std::memory_order_acquire);
+            if (seq == pos + 1) {
+                if (dequeue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    popped_item = std::move(s.item);
+                    s.seq.store(pos + max_items_, std::memory_order_release);
+                    return true;
+                }
+            } else if (seq < pos + 1) {
+                return false;  // empty
+            } else {
+                pos = dequeue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // pop up to max_items more items without waiting, and wake the producers.
+    size_t dequeue_more_(T *popped_items, size_t max_items) {
+        size_t n = 0;
+        while (n < max_items && try_dequeue_(popped_items[n])) {
+            n++;
+        }
+        notify_(pop_cv_, waiting_producers_);
+        return n;
+    }
+
+    // wake a parked thread, if any. the fence pairs with the one in wait_for_() so that
+    // either the waiter sees our update or we see the waiter.
+    void notify_(std::condition_variable &cv, std::atomic<size_t> &waiters) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiters.load(std::memory_order_relaxed) != 0) {
+            std::lock_guard<std::mutex> lock(park_mutex_);
+            cv.notify_all();
+        }
+    }
+
+    template <typename Pred>
+    void wait_(std::condition_variable &cv, std::atomic<size_t> &waiters, Pred pred) {
+        while (!wait_for_(cv, waiters, std::chrono::milliseconds(100), pred)) {
+        }
+    }
+
+    template <typename Pred>
+    bool wait_for_(std::condition_variable &cv,
+                   std::atomic<size_t> &waiters,
+                   std::chrono::milliseconds wait_duration,
+                   Pred pred) {
+        auto deadline = std::chrono::steady_clock::now() + wait_duration;
+        if (spin_wait(strategy_, pred, deadline)) {
+            return true;
+        }
+        if (strategy_.mode != wait_mode::park) {
+            return false;
+        }
+        std::unique_lock<std::mutex> lock(park_mutex_);
+        waiters.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        bool ready = cv.wait_for(lock, wait_duration, pred);
+        waiters.fetch_sub(1, std::memory_order_relaxed);
+        return ready;
+    }
+
+    const size_t max_items_;
+    const wait_strategy strategy_;
+    std::unique_ptr<slot[]> slots_;
+
+    // keep the producer and consumer positions on separate cache lines
+    alignas(cache_line_size) std::atomic<size_t> enqueue_pos_{0};
+    alignas(cache_line_size) std::atomic<size_t> dequeue_pos_{0};
+
+    alignas(cache_line_size) std::atomic<size_t> overrun_counter_{0};
+    std::atomic<size_t> discard_counter_{0};
+    std::atomic<size_t> waiting_producers_{0};
+    std::atomic<size_t> waiting_consumers_{0};
+    std::mutex park_mutex_;
+    std::condition_variable push_cv_;
+    std::condition_variable pop_cv_;
+};
+}  // namespace details
+}  // namespace spdlog
@@ -11,6 +11,7 @@
 
 #include <algorithm>
 #include <array>
+#include <cerrno>
 #include <chrono>
 #include <cstdio>
 #include <cstdlib>
@@ -43,6 +44,8 @@
     #include <unistd.h>
 
     #ifdef __linux__
+        #include <sched.h>         // for sched_setaffinity, sched_setscheduler
+        #include <sys/resource.h>  // for setpriority
         #include <sys/syscall.h>  //Use gettid() syscall under linux to get thread id
 
     #elif defined(_AIX)
@@ -377,6 +380,51 @@ SPDLOG_INLINE void sleep_for_millis(unsigned int milliseconds) SPDLOG_NOEXCEPT {
 #endif
 }
 
+SPDLOG_INLINE int set_thread_affinity(int cpu) SPDLOG_NOEXCEPT {
+    if (cpu < 0) {
+        return EINVAL;
+    }
+#if defined(_WIN32)
+    if (cpu >= static_cast<int>(sizeof(DWORD_PTR) * 8)) {
+        return EINVAL;
+    }
+    auto mask = static_cast<DWORD_PTR>(1) << cpu;
+    return ::SetThreadAffinityMask(::GetCurrentThread(), mask) != 0 ? 0 : EINVAL;
+#elif defined(__linux__) && !defined(__ANDROID__)
+    if (cpu >= CPU_SETSIZE) {
+        return EINVAL;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return ::sched_setaffinity(0, sizeof(set), &set) == 0 ? 0 : errno;
+#else
+    return ENOTSUP;
+#endif
+}
+
+SPDLOG_INLINE int set_thread_scheduling(int policy, int priority) SPDLOG_NOEXCEPT {
+#if defined(__linux__)
+    sched_param param{};
+    param.sched_priority = priority;
+    return ::sched_setscheduler(0, policy, &param) == 0 ? 0 : errno;
+#else
+    (void)policy;
+    (void)priority;
+    return ENOTSUP;
+#endif
+}
+
+SPDLOG_INLINE int set_thread_nice(int nice_value) SPDLOG_NOEXCEPT {
+#if defined(__linux__)
+    auto tid = static_cast<id_t>(::syscall(SYS_gettid));
+    return ::setpriority(PRIO_PROCESS, tid, nice_value) == 0 ? 0 : errno;
+#else
+    (void)nice_value;
+    return ENOTSUP;
+#endif
+}
+
 // wchar support for windows file names (SPDLOG_WCHAR_FILENAMES must be defined)
 #if defined(_WIN32) && defined(SPDLOG_WCHAR_FILENAMES)
 SPDLOG_INLINE std::string filename_to_str(const filename_t &filename) {
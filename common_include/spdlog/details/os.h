@@ -77,6 +77,18 @@ SPDLOG_API size_t thread_id() SPDLOG_NOEXCEPT;
 // See https://github.com/gabime/spdlog/issues/609
 SPDLOG_API void sleep_for_millis(unsigned int milliseconds) SPDLOG_NOEXCEPT;
 
+// Pin the calling thread to the given cpu.
+// Return 0 on success, an errno value otherwise (ENOTSUP if not supported on this platform).
+SPDLOG_API int set_thread_affinity(int cpu) SPDLOG_NOEXCEPT;
+
+// Set the scheduling policy (SCHED_*) and priority of the calling thread (linux only).
+// Return 0 on success, an errno value otherwise.
+SPDLOG_API int set_thread_scheduling(int policy, int priority) SPDLOG_NOEXCEPT;
+
+// Set the nice value of the calling thread (linux only, where nice is per thread).
+// Return 0 on success, an errno value otherwise.
+SPDLOG_API int set_thread_nice(int nice_value) SPDLOG_NOEXCEPT;
+
 SPDLOG_API std::string filename_to_str(const filename_t &filename);
 
 SPDLOG_API int pid() SPDLOG_NOEXCEPT;
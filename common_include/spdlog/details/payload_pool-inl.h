@@ -0,0 +1,73 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#ifndef SPDLOG_HEADER_ONLY
+    #include <spdlog/details/payload_pool.h>
+#endif
+
+namespace spdlog {
+namespace details {
+
+SPDLOG_INLINE payload_pool &payload_pool::instance() {
+    static payload_pool s_instance;
+    return s_instance;
+}
+
+SPDLOG_INLINE payload_pool::payload_pool() {
+    // reserve up front so that deallocate() never allocates
+    for (auto &c : classes_) {
+        c.free_list.reserve(max_free_per_class);
+    }
+}
+
+SPDLOG_INLINE payload_pool::~payload_pool() {
+    for (auto &c : classes_) {
+        for (auto *buf : c.free_list) {
+            delete[] buf;
+        }
+    }
+}
+
+SPDLOG_INLINE char *payload_pool::allocate(size_t size, size_t &capacity) {
+    size_t class_size = min_class_size;
+    for (size_t i = 0; i < n_classes; i++, class_size *= 2) {
+        if (size > class_size) {
+            continue;
+        }
+        capacity = class_size;
+        {
+            std::lock_guard<std::mutex> lock(classes_[i].mutex);
+            auto &free_list = classes_[i].free_list;
+            if (!free_list.empty()) {
+                auto *buf = free_list.back();
+                free_list.pop_back();
+                return buf;
+            }
+        }
+        return new char[class_size];
+    }
+    capacity = size;
+    return new char[size];
+}
+
+SPDLOG_INLINE void payload_pool::deallocate(char *buf, size_t capacity) SPDLOG_NOEXCEPT {
+    size_t class_size = min_class_size;
+    for (size_t i = 0; i < n_classes; i++, class_size *= 2) {
+        if (capacity != class_size) {
+            continue;
+        }
+        std::lock_guard<std::mutex> lock(classes_[i].mutex);
+        auto &free_list = classes_[i].free_list;
+        if (free_list.size() < max_free_per_class) {
+            free_list.push_back(buf);
+            return;
+        }
+        break;
+    }
+    delete[] buf;
+}
+
+}  // namespace details
+}  // namespace spdlog
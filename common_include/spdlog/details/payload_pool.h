@@ -0,0 +1,51 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// Pool of spill buffers for async messages whose payload doesn't fit in the inline area.
+// Buffers are grouped in power of two size classes and recycled through a small free list
+// per class, so steady traffic of large messages doesn't hit the heap.
+// Buffers above the largest class are plain heap allocations.
+
+#include <spdlog/common.h>
+
+#include <mutex>
+#include <vector>
+
+namespace spdlog {
+namespace details {
+
+class SPDLOG_API payload_pool {
+public:
+    static payload_pool &instance();
+
+    payload_pool(const payload_pool &) = delete;
+    payload_pool &operator=(const payload_pool &) = delete;
+
+    // return a buffer of at least size bytes. its real size is stored in capacity.
+    char *allocate(size_t size, size_t &capacity);
+    // capacity must be the value returned by allocate()
+    void deallocate(char *buf, size_t capacity) SPDLOG_NOEXCEPT;
+
+private:
+    payload_pool();
+    ~payload_pool();
+
+    static const size_t min_class_size = 512;
+    static const size_t n_classes = 8;  // 512 bytes .. 64KB
+    static const size_t max_free_per_class = 64;
+
+    struct size_class {
+        std::mutex mutex;
+        std::vector<char *> free_list;
+    };
+    size_class classes_[n_classes];
+};
+
+}  // namespace details
+}  // namespace spdlog
+
+#ifdef SPDLOG_HEADER_ONLY
+    #include "payload_pool-inl.h"
+#endif
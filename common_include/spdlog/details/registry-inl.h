@@ -185,19 +185,44 @@ SPDLOG_INLINE void registry::flush_all() {
     }
 }
 
-SPDLOG_INLINE void registry::drop(const std::string &logger_name) {
+SPDLOG_INLINE void registry::request_flush_all() {
     std::lock_guard<std::mutex> lock(logger_map_mutex_);
-    auto is_default_logger = default_logger_ && default_logger_->name() == logger_name;
-    loggers_.erase(logger_name);
-    if (is_default_logger) {
-        default_logger_.reset();
+    for (auto &l : loggers_) {
+        l.second->request_flush();
+    }
+}
+
+// the dropped loggers are told outside the lock (an async logger may wait for room in the
+// queue of its thread pool)
+SPDLOG_INLINE void registry::drop(const std::string &logger_name) {
+    std::shared_ptr<logger> dropped;
+    {
+        std::lock_guard<std::mutex> lock(logger_map_mutex_);
+        auto is_default_logger = default_logger_ && default_logger_->name() == logger_name;
+        auto found = loggers_.find(logger_name);
+        if (found != loggers_.end()) {
+            dropped = std::move(found->second);
+            loggers_.erase(found);
+        }
+        if (is_default_logger) {
+            default_logger_.reset();
+        }
+    }
+    if (dropped) {
+        dropped->on_drop();
     }
 }
 
 SPDLOG_INLINE void registry::drop_all() {
-    std::lock_guard<std::mutex> lock(logger_map_mutex_);
-    loggers_.clear();
-    default_logger_.reset();
+    std::unordered_map<std::string, std::shared_ptr<logger>> dropped;
+    {
+        std::lock_guard<std::mutex> lock(logger_map_mutex_);
+        dropped.swap(loggers_);
+        default_logger_.reset();
+    }
+    for (auto &l : dropped) {
+        l.second->on_drop();
+    }
 }
 
 // clean all resources and threads started by the registry
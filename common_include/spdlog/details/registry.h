@@ -67,7 +67,7 @@ public:
     template <typename Rep, typename Period>
     void flush_every(std::chrono::duration<Rep, Period> interval) {
         std::lock_guard<std::mutex> lock(flusher_mutex_);
-        auto clbk = [this]() { this->flush_all(); };
+        auto clbk = [this]() { this->request_flush_all(); };
         periodic_flusher_ = details::make_unique<periodic_worker>(clbk, interval);
     }
 
@@ -82,6 +82,9 @@ public:
 
     void flush_all();
 
+    // request_flush() on all the loggers: sinks with a flush policy flush only when it's due
+    void request_flush_all();
+
     void drop(const std::string &logger_name);
 
     void drop_all();
@@ -0,0 +1,57 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// Formatted output of one message, shared by the sinks of a logger.
+//
+// Each sink that writes its formatted output as is (see base_sink::accepts_formatted_()) keeps
+// the id of its formatter's output key (see formatter::output_key()). The first such sink formats
+// the message into the shared buffer; the next sinks with the same id write the buffer instead
+// of formatting the message again.
+// shared_batch_format does the same for the runs of messages of the async batch path.
+
+#include <spdlog/common.h>
+
+#include <algorithm>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace spdlog {
+namespace details {
+
+struct log_msg;
+
+struct shared_format {
+    size_t format_id = 0;  // 0: nothing formatted yet
+    memory_buf_t formatted;
+};
+
+// outputs of a run of messages, back to back. sinks share it only if they log the same messages
+// (they may filter the run by level).
+struct shared_batch_format {
+    size_t format_id = 0;  // 0: nothing formatted yet
+    std::vector<const log_msg *> msgs;
+    memory_buf_t formatted;
+    std::vector<size_t> ends;  // ends[i]: end of the output of msgs[i] in formatted
+
+    bool holds(const log_msg *const *batch, size_t count) const {
+        return msgs.size() == count && std::equal(msgs.begin(), msgs.end(), batch);
+    }
+};
+
+// id of the given formatter output key. equal keys get equal ids, the empty key gets 0.
+inline size_t format_id(const std::string &output_key) {
+    if (output_key.empty()) {
+        return 0;
+    }
+    static std::mutex mutex;
+    static std::unordered_map<std::string, size_t> ids;
+    std::lock_guard<std::mutex> lock(mutex);
+    return ids.emplace(output_key, ids.size() + 1).first->second;
+}
+
+}  // namespace details
+}  // namespace spdlog
@@ -0,0 +1,97 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// bounded single producer, multiple consumer queue used as a per-thread staging ring by the
+// async thread pool.
+// try_push(..) - only to be called by the owning producer thread. never blocks, and moves
+// the item only on success.
+// try_pop(..) - may be called by the consumers and by the producer itself (to overrun the
+// oldest item), so the read side claims slots with a CAS.
+//
+// The producer position is written by a single thread only, so the push fast path is a plain
+// store to memory that no other producer ever touches.
+
+#include <spdlog/details/mpmc_lockfree_q.h>
+
+#include <atomic>
+#include <memory>
+
+namespace spdlog {
+namespace details {
+
+template <typename T>
+class spmc_queue {
+public:
+    using item_type = T;
+
+    explicit spmc_queue(size_t max_items)
+        : max_items_(max_items > 0 ? max_items : 1),
+          slots_(new slot[max_items_]) {
+        for (size_t i = 0; i < max_items_; i++) {
+            slots_[i].seq.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    spmc_queue(const spmc_queue &) = delete;
+    spmc_queue &operator=(const spmc_queue &) = delete;
+
+    bool try_push(T &item) {
+        auto pos = head_.load(std::memory_order_relaxed);
+        auto &s = slots_[pos % max_items_];
+        if (s.seq.load(std::memory_order_acquire) != pos) {
+            return false;  // full
+        }
+        s.item = std::move(item);
+        s.seq.store(pos + 1, std::memory_order_release);
+        head_.store(pos + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    bool try_pop(T &popped_item) {
+        auto pos = tail_.load(std::memory_order_relaxed);
+        for (;;) {
+            auto &s = slots_[pos % max_items_];
+            auto seq = s.seq.load(std::memory_order_acquire);
+            if (seq == pos + 1) {
+                if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    popped_item = std::move(s.item);
+                    s.seq.store(pos + max_items_, std::memory_order_release);
+                    return true;
+                }
+            } else if (seq < pos + 1) {
+                return false;  // empty
+            } else {
+                pos = tail_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // approximate number of items in the queue
+    size_t size() const {
+        auto tail = tail_.load(std::memory_order_relaxed);
+        auto head = head_.load(std::memory_order_relaxed);
+        return head > tail ? head - tail : 0;
+    }
+
+    bool empty() const { return size() == 0; }
+
+    // number of items pushed (popped) so far
+    size_t pushed() const { return head_.load(std::memory_order_relaxed); }
+    size_t popped() const { return tail_.load(std::memory_order_relaxed); }
+
+private:
+    struct alignas(cache_line_size) slot {
+        std::atomic<size_t> seq{0};
+        T item;
+    };
+
+    const size_t max_items_;
+    std::unique_ptr<slot[]> slots_;
+
+    alignas(cache_line_size) std::atomic<size_t> head_{0};
+    alignas(cache_line_size) std::atomic<size_t> tail_{0};
+};
+}  // namespace details
+}  // namespace spdlog
@@ -7,7 +7,9 @@
     #include <spdlog/details/thread_pool.h>
 #endif
 
+#include <algorithm>
 #include <cassert>
+#include <utility>
 #include <spdlog/common.h>
 
 namespace spdlog {
@@ -16,22 +18,124 @@ namespace details {
 SPDLOG_INLINE thread_pool::thread_pool(size_t q_max_items,
                                        size_t threads_n,
                                        std::function<void()> on_thread_start,
-                                       std::function<void()> on_thread_stop)
-    : q_(q_max_items) {
+                                       std::function<void()> on_thread_stop,
+                                       const thread_pool_options &options)
+    : options_(options),
+      q_max_items_(q_max_items) {
+    // unique id per pool, used as key of the per thread staging ring cache
+    static std::atomic<size_t> last_id{0};
+    id_ = last_id.fetch_add(1, std::memory_order_relaxed) + 1;
+
     if (threads_n == 0 || threads_n > 1000) {
         throw_spdlog_ex(
             "spdlog::thread_pool(): invalid threads_n param (valid "
             "range is 1-1000)");
     }
+#ifdef SPDLOG_NO_TLS
+    if (options_.per_thread_queues) {
+        throw_spdlog_ex("spdlog::thread_pool(): per_thread_queues requires thread local storage");
+    }
+#endif
+    if (options_.drain_batch_size == 0) {
+        options_.drain_batch_size = 1;
+    }
+    if (options_.per_thread_queues) {
+        if (options_.sharded) {
+            throw_spdlog_ex("spdlog::thread_pool(): per_thread_queues can't be sharded");
+        }
+        options_.first_touch_queue = false;
+    }
+    queues_.resize(options_.sharded ? threads_n : 1);
+    metrics_.reset(new shard_metrics[queues_.size()]);
+    if (!options_.first_touch_queue) {
+        for (auto &q : queues_) {
+            q.reset(new q_type(options_.per_thread_queues ? 1 : q_max_items, options_.wait));
+        }
+    }
+
+    auto gate = std::make_shared<start_gate>();
+    // if starting a worker throws, let the started ones through the gate (they see the error
+    // and return without touching the queues) and join them before the exception leaves,
+    // since destroying a joinable std::thread calls std::terminate.
+    struct start_guard {
+        std::vector<std::thread> &threads;
+        start_gate &gate;
+        bool started = false;
+        ~start_guard() {
+            if (started) {
+                return;
+            }
+            {
+                std::lock_guard<std::mutex> lock(gate.mutex);
+                if (gate.error.empty()) {
+                    gate.error = "failed to start the workers";
+                }
+                gate.released = true;
+            }
+            gate.cv.notify_all();
+            for (auto &t : threads) {
+                t.join();
+            }
+        }
+    } guard{threads_, *gate};
+    threads_.reserve(threads_n);
     for (size_t i = 0; i < threads_n; i++) {
-        threads_.emplace_back([this, on_thread_start, on_thread_stop] {
+        threads_.emplace_back([this, i, gate, on_thread_start, on_thread_stop] {
+            std::string error;
+            int error_errno = 0;
+            bool placed = this->place_worker_(i, error, error_errno);
+            {
+                std::unique_lock<std::mutex> lock(gate->mutex);
+                if (!placed && gate->error.empty()) {
+                    gate->error = std::move(error);
+                    gate->error_errno = error_errno;
+                }
+                gate->ready++;
+                gate->cv.notify_all();
+                gate->cv.wait(lock, [&gate] { return gate->released; });
+                if (!gate->error.empty()) {
+                    return;
+                }
+            }
             on_thread_start();
-            this->thread_pool::worker_loop_();
+            if (this->options_.per_thread_queues) {
+                this->thread_pool::staging_worker_loop_();
+            } else {
+                this->thread_pool::worker_loop_(i, i % this->queues_.size());
+            }
             on_thread_stop();
         });
     }
+    guard.started = true;
+
+    {
+        std::unique_lock<std::mutex> lock(gate->mutex);
+        gate->cv.wait(lock, [&gate, threads_n] { return gate->ready == threads_n; });
+        gate->released = true;
+    }
+    gate->cv.notify_all();
+    if (!gate->error.empty()) {
+        for (auto &t : threads_) {
+            t.join();
+        }
+        auto msg = "spdlog::thread_pool(): " + gate->error;
+        if (gate->error_errno != 0) {
+            throw_spdlog_ex(msg, gate->error_errno);
+        }
+        throw_spdlog_ex(msg);
+    }
 }
 
+SPDLOG_INLINE thread_pool::thread_pool(size_t q_max_items,
+                                       size_t threads_n,
+                                       std::function<void()> on_thread_start,
+                                       std::function<void()> on_thread_stop)
+    : thread_pool(q_max_items,
+                  threads_n,
+                  std::move(on_thread_start),
+                  std::move(on_thread_stop),
+                  thread_pool_options{}) {}
+
 SPDLOG_INLINE thread_pool::thread_pool(size_t q_max_items,
                                        size_t threads_n,
                                        std::function<void()> on_thread_start)
@@ -43,8 +147,15 @@ SPDLOG_INLINE thread_pool::thread_pool(size_t q_max_items, size_t threads_n)
 // message all threads to terminate gracefully join them
 SPDLOG_INLINE thread_pool::~thread_pool() {
     SPDLOG_TRY {
-        for (size_t i = 0; i < threads_.size(); i++) {
-            post_async_msg_(async_msg(async_msg_type::terminate), async_overflow_policy::block);
+        if (options_.per_thread_queues) {
+            // workers exit after draining all rings once they see the stop flag
+            staging_stop_.store(true, std::memory_order_release);
+            wake_staging_workers_();
+        } else {
+            // one per worker, into the queue the worker reads
+            for (size_t i = 0; i < threads_.size(); i++) {
+                queues_[i % queues_.size()]->enqueue(async_msg(async_msg_type::terminate));
+            }
         }
 
         for (auto &t : threads_) {
@@ -54,71 +165,778 @@ SPDLOG_INLINE thread_pool::~thread_pool() {
     SPDLOG_CATCH_STD
 }
 
-void SPDLOG_INLINE thread_pool::post_log(async_logger_ptr &&worker_ptr,
+bool SPDLOG_INLINE thread_pool::place_worker_(size_t index,
+                                             std::string &error,
+                                             int &error_errno) {
+    auto worker = std::to_string(index);
+    if (!options_.cpu_affinity.empty()) {
+        int cpu = options_.cpu_affinity[index % options_.cpu_affinity.size()];
+        error_errno = os::set_thread_affinity(cpu);
+        if (error_errno != 0) {
+            error = "failed to pin worker " + worker + " to cpu " + std::to_string(cpu);
+            return false;
+        }
+    }
+    if (options_.sched_policy != -1) {
+        error_errno = os::set_thread_scheduling(options_.sched_policy, options_.sched_priority);
+        if (error_errno != 0) {
+            error = "failed to set scheduling policy of worker " + worker;
+            return false;
+        }
+    }
+    if (options_.nice != 0) {
+        error_errno = os::set_thread_nice(options_.nice);
+        if (error_errno != 0) {
+            error = "failed to set nice value of worker " + worker;
+            return false;
+        }
+    }
+    if (options_.first_touch_queue && index < queues_.size()) {
+        SPDLOG_TRY { queues_[index].reset(new q_type(q_max_items_, options_.wait)); }
+        SPDLOG_CATCH_STD
+        if (!queues_[index]) {
+            error = "failed to allocate the queue of worker " + worker;
+            return false;
+        }
+    }
+    return true;
+}
+
+void SPDLOG_INLINE thread_pool::post_log(async_logger *worker_ptr,
                                          const details::log_msg &msg,
-                                         async_overflow_policy overflow_policy) {
-    async_msg async_m(std::move(worker_ptr), async_msg_type::log, msg);
+                                         async_overflow_policy overflow_policy,
+                                         deferred_format_fn format_fn) {
+    async_msg async_m(worker_ptr, async_msg_type::log, msg, format_fn);
     post_async_msg_(std::move(async_m), overflow_policy);
 }
 
-void SPDLOG_INLINE thread_pool::post_flush(async_logger_ptr &&worker_ptr,
+void SPDLOG_INLINE thread_pool::post_flush(async_logger *worker_ptr,
                                            async_overflow_policy overflow_policy) {
-    post_async_msg_(async_msg(std::move(worker_ptr), async_msg_type::flush), overflow_policy);
+    post_async_msg_(async_msg(worker_ptr, async_msg_type::flush), overflow_policy);
+}
+
+void SPDLOG_INLINE thread_pool::post_flush_request(async_logger *worker_ptr,
+                                                   async_overflow_policy overflow_policy) {
+    post_async_msg_(async_msg(worker_ptr, async_msg_type::flush_request), overflow_policy);
+}
+
+void SPDLOG_INLINE thread_pool::hold_logger(async_logger_ptr &&worker_ptr) {
+    std::lock_guard<std::mutex> lock(loggers_mutex_);
+    if (!worker_ptr->held_by_pool_.load(std::memory_order_relaxed)) {
+        worker_ptr->held_by_pool_.store(true, std::memory_order_release);
+        held_loggers_.push_back(std::move(worker_ptr));
+    }
+}
+
+void SPDLOG_INLINE thread_pool::release_logger(async_logger *worker_ptr) {
+    size_t release_id = 0;
+    {
+        std::lock_guard<std::mutex> lock(loggers_mutex_);
+        auto held = std::find_if(held_loggers_.begin(), held_loggers_.end(),
+                                 [worker_ptr](const async_logger_ptr &l) {
+                                     return l.get() == worker_ptr;
+                                 });
+        if (held == held_loggers_.end()) {
+            return;
+        }
+        // logging again takes a new reference
+        worker_ptr->held_by_pool_.store(false, std::memory_order_release);
+        retiring_logger retiring;
+        retiring.id = ++last_release_id_;
+        release_id = retiring.id;
+        retiring.logger = std::move(*held);
+        held_loggers_.erase(held);
+        if (options_.per_thread_queues) {
+            std::lock_guard<std::mutex> staging_lock(staging_mutex_);
+            for (auto &ring : staging_rings_) {
+                retiring.ring_positions.emplace_back(ring, ring->q.pushed());
+            }
+        } else {
+            retiring.seen_in.assign(queues_.size(), false);
+            retiring.released_by.assign(threads_.size(), false);
+            retiring.pending_workers = threads_.size();
+        }
+        retiring_.push_back(std::move(retiring));
+        retiring_count_.fetch_add(1, std::memory_order_release);
+    }
+
+    if (options_.per_thread_queues) {
+        wake_staging_workers_();
+        return;
+    }
+    // one per worker, into the queue the worker reads, like the terminate messages
+    for (size_t i = 0; i < threads_.size(); i++) {
+        async_msg release(worker_ptr, async_msg_type::release);
+        release.release_id = release_id;
+        queues_[i % queues_.size()]->enqueue(std::move(release));
+    }
+}
+
+// once the release message was taken from a queue, the messages posted to it before are all
+// taken too, and a worker has processed those it took once it finishes its current batch.
+void SPDLOG_INLINE thread_pool::handle_release_(const async_msg &msg, size_t shard) {
+    std::lock_guard<std::mutex> lock(loggers_mutex_);
+    for (auto &retiring : retiring_) {
+        if (retiring.id == msg.release_id) {
+            retiring.seen_in[shard] = true;
+            return;
+        }
+    }
+}
+
+void SPDLOG_INLINE thread_pool::release_retired_(size_t worker) {
+    std::vector<async_logger_ptr> released;
+    {
+        std::lock_guard<std::mutex> lock(loggers_mutex_);
+        for (auto it = retiring_.begin(); it != retiring_.end();) {
+            auto seen = std::find(it->seen_in.begin(), it->seen_in.end(), false) ==
+                        it->seen_in.end();
+            if (seen && !it->released_by[worker]) {
+                it->released_by[worker] = true;
+                it->pending_workers--;
+            }
+            if (seen && it->pending_workers == 0) {
+                released.push_back(std::move(it->logger));
+                it = retiring_.erase(it);
+                retiring_count_.fetch_sub(1, std::memory_order_relaxed);
+            } else {
+                ++it;
+            }
+        }
+    }
+    // the loggers (and their sinks) are destroyed here, outside the lock
 }
 
-size_t SPDLOG_INLINE thread_pool::overrun_counter() { return q_.overrun_counter(); }
+size_t SPDLOG_INLINE thread_pool::overrun_counter() {
+    size_t total = staging_overrun_counter_.load(std::memory_order_relaxed);
+    for (auto &q : queues_) {
+        total += q->overrun_counter();
+    }
+    return total;
+}
+
+void SPDLOG_INLINE thread_pool::reset_overrun_counter() {
+    for (auto &q : queues_) {
+        q->reset_overrun_counter();
+    }
+    staging_overrun_counter_.store(0, std::memory_order_relaxed);
+}
 
-void SPDLOG_INLINE thread_pool::reset_overrun_counter() { q_.reset_overrun_counter(); }
+size_t SPDLOG_INLINE thread_pool::discard_counter() {
+    size_t total = staging_discard_counter_.load(std::memory_order_relaxed);
+    for (auto &q : queues_) {
+        total += q->discard_counter();
+    }
+    return total;
+}
 
-size_t SPDLOG_INLINE thread_pool::discard_counter() { return q_.discard_counter(); }
+void SPDLOG_INLINE thread_pool::reset_discard_counter() {
+    for (auto &q : queues_) {
+        q->reset_discard_counter();
+    }
+    staging_discard_counter_.store(0, std::memory_order_relaxed);
+}
 
-void SPDLOG_INLINE thread_pool::reset_discard_counter() { q_.reset_discard_counter(); }
+size_t SPDLOG_INLINE thread_pool::shard_count() const { return queues_.size(); }
 
-size_t SPDLOG_INLINE thread_pool::queue_size() { return q_.size(); }
+clock_source SPDLOG_INLINE thread_pool::clock() const { return options_.clock; }
+
+size_t SPDLOG_INLINE thread_pool::queue_size() {
+    if (!options_.per_thread_queues) {
+        size_t total = 0;
+        for (auto &q : queues_) {
+            total += q->size();
+        }
+        return total;
+    }
+    std::lock_guard<std::mutex> lock(staging_mutex_);
+    size_t total = 0;
+    for (auto &ring : staging_rings_) {
+        total += ring->q.size();
+    }
+    return total;
+}
 
 void SPDLOG_INLINE thread_pool::post_async_msg_(async_msg &&new_msg,
                                                 async_overflow_policy overflow_policy) {
-    if (overflow_policy == async_overflow_policy::block) {
-        q_.enqueue(std::move(new_msg));
+    if (options_.per_thread_queues && new_msg.msg_type != async_msg_type::terminate) {
+        post_staging_msg_(std::move(new_msg), overflow_policy);
+    } else if (overflow_policy == async_overflow_policy::block) {
+        auto &q = queue_of_(new_msg.worker_ptr);
+        if (!options_.collect_metrics) {
+            q.enqueue(std::move(new_msg));
+        } else if (!q.try_enqueue(std::move(new_msg))) {
+            // only enqueues that actually block pay for the clock reads
+            auto since = std::chrono::steady_clock::now();
+            auto shard = shard_of_(new_msg.worker_ptr);
+            q.enqueue(std::move(new_msg));
+            record_blocked_(shard, since);
+        }
     } else if (overflow_policy == async_overflow_policy::overrun_oldest) {
-        q_.enqueue_nowait(std::move(new_msg));
+        queue_of_(new_msg.worker_ptr).enqueue_nowait(std::move(new_msg));
     } else {
         assert(overflow_policy == async_overflow_policy::discard_new);
-        q_.enqueue_if_have_room(std::move(new_msg));
+        queue_of_(new_msg.worker_ptr).enqueue_if_have_room(std::move(new_msg));
+    }
+}
+
+SPDLOG_INLINE size_t thread_pool::shard_of_(const async_logger *worker_ptr) const {
+    if (queues_.size() == 1) {
+        return 0;
     }
+    return worker_ptr->shard_.load(std::memory_order_relaxed) % queues_.size();
 }
 
-void SPDLOG_INLINE thread_pool::worker_loop_() {
-    while (process_next_msg_()) {
+SPDLOG_INLINE thread_pool::q_type &thread_pool::queue_of_(const async_logger *worker_ptr) {
+    return *queues_[shard_of_(worker_ptr)];
+}
+
+void SPDLOG_INLINE thread_pool::worker_loop_(size_t worker, size_t shard) {
+    msg_batch batch;
+    batch.msgs.resize(options_.drain_batch_size);
+    batch.worker = worker;
+    batch.mark = std::chrono::steady_clock::now();
+    while (process_next_batch_(shard, batch)) {
     }
 }
 
-// process next message in the queue
+// process next batch of messages in the queue
 // returns true if this thread should still be active (while no terminated msg was received)
-bool SPDLOG_INLINE thread_pool::process_next_msg_() {
-    async_msg incoming_async_msg;
-    q_.dequeue(incoming_async_msg);
+bool SPDLOG_INLINE thread_pool::process_next_batch_(size_t shard, msg_batch &batch) {
+    auto &q = *queues_[shard];
+    // wake up now and then to take part in the release of dropped loggers
+    auto n = q.dequeue_bulk_for(batch.msgs.data(), batch.msgs.size(),
+                                std::chrono::milliseconds(100));
+    if (n == 0) {
+        if (retiring_count_.load(std::memory_order_acquire) != 0) {
+            release_retired_(batch.worker);
+        }
+        return true;
+    }
+    batch.ordered.clear();
+    for (size_t i = 0; i < n; i++) {
+        batch.ordered.push_back(&batch.msgs[i]);
+    }
+    if (options_.collect_metrics) {
+        record_period_(shard, batch, false);
+        // other workers of the queue may have taken messages meanwhile, so cap at the capacity
+        record_batch_(shard, batch, (std::min)(n + q.size(), q_max_items_));
+    }
+    auto terminates = process_batch_(batch);
+    if (options_.collect_metrics) {
+        record_period_(shard, batch, true);
+    }
+    if (retiring_count_.load(std::memory_order_acquire) != 0) {
+        release_retired_(batch.worker);
+    }
 
-    switch (incoming_async_msg.msg_type) {
-        case async_msg_type::log: {
-            incoming_async_msg.worker_ptr->backend_sink_it_(incoming_async_msg);
-            return true;
+    // a terminate message meant for another worker was taken along. hand it back.
+    for (size_t i = 1; i < terminates; i++) {
+        q.enqueue(async_msg(async_msg_type::terminate));
+    }
+    return terminates == 0;
+}
+
+//
+// metrics
+//
+template <typename T>
+void atomic_store_max(std::atomic<T> &target, T value) {
+    auto current = target.load(std::memory_order_relaxed);
+    while (current < value &&
+           !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
+// index of the highest set bit, 0 for 0
+inline size_t latency_bucket(std::uint64_t ns) {
+#if defined(__GNUC__) || defined(__clang__)
+    return ns == 0 ? 0 : static_cast<size_t>(63 - __builtin_clzll(ns));
+#else
+    size_t bucket = 0;
+    while (ns >>= 1) {
+        bucket++;
+    }
+    return bucket;
+#endif
+}
+
+SPDLOG_INLINE void thread_pool::shard_metrics::reset() {
+    queue_high_water.store(0, std::memory_order_relaxed);
+    blocked_count.store(0, std::memory_order_relaxed);
+    blocked_ns.store(0, std::memory_order_relaxed);
+    blocked_max_ns.store(0, std::memory_order_relaxed);
+    for (auto &bucket : latency_histogram) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    busy_ns.store(0, std::memory_order_relaxed);
+    idle_ns.store(0, std::memory_order_relaxed);
+}
+
+SPDLOG_INLINE async_metrics thread_pool::metrics(size_t shard) const {
+    if (shard >= queues_.size()) {
+        throw_spdlog_ex("thread_pool::metrics(): invalid shard " + std::to_string(shard));
+    }
+    auto &m = metrics_[shard];
+    async_metrics result;
+    result.queue_high_water = m.queue_high_water.load(std::memory_order_relaxed);
+    result.blocked_count = m.blocked_count.load(std::memory_order_relaxed);
+    result.blocked_total = std::chrono::nanoseconds(m.blocked_ns.load(std::memory_order_relaxed));
+    result.blocked_max =
+        std::chrono::nanoseconds(m.blocked_max_ns.load(std::memory_order_relaxed));
+    for (size_t i = 0; i < async_metrics::latency_buckets; i++) {
+        result.latency_histogram[i] = m.latency_histogram[i].load(std::memory_order_relaxed);
+    }
+    result.busy = std::chrono::nanoseconds(m.busy_ns.load(std::memory_order_relaxed));
+    result.idle = std::chrono::nanoseconds(m.idle_ns.load(std::memory_order_relaxed));
+    return result;
+}
+
+SPDLOG_INLINE async_metrics thread_pool::metrics() const {
+    async_metrics total;
+    for (size_t shard = 0; shard < queues_.size(); shard++) {
+        auto m = metrics(shard);
+        total.queue_high_water = (std::max)(total.queue_high_water, m.queue_high_water);
+        total.blocked_count += m.blocked_count;
+        total.blocked_total += m.blocked_total;
+        total.blocked_max = (std::max)(total.blocked_max, m.blocked_max);
+        for (size_t i = 0; i < async_metrics::latency_buckets; i++) {
+            total.latency_histogram[i] += m.latency_histogram[i];
         }
-        case async_msg_type::flush: {
-            incoming_async_msg.worker_ptr->backend_flush_();
-            return true;
+        total.busy += m.busy;
+        total.idle += m.idle;
+    }
+    return total;
+}
+
+SPDLOG_INLINE void thread_pool::reset_metrics() {
+    for (size_t shard = 0; shard < queues_.size(); shard++) {
+        metrics_[shard].reset();
+    }
+}
+
+SPDLOG_INLINE void thread_pool::record_blocked_(size_t shard,
+                                                std::chrono::steady_clock::time_point since) {
+    auto ns = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                             std::chrono::steady_clock::now() - since)
+                                             .count());
+    auto &m = metrics_[shard];
+    m.blocked_count.fetch_add(1, std::memory_order_relaxed);
+    m.blocked_ns.fetch_add(ns, std::memory_order_relaxed);
+    atomic_store_max(m.blocked_max_ns, ns);
+}
+
+// queue depth and log call to dequeue latency of the messages of a batch.
+// the latency is measured with the clock of the logger that stamped the message.
+SPDLOG_INLINE void thread_pool::record_batch_(size_t shard, const msg_batch &batch, size_t depth) {
+    auto &m = metrics_[shard];
+    atomic_store_max(m.queue_high_water, depth);
+
+    std::uint32_t counts[async_metrics::latency_buckets] = {};
+    const size_t clocks = static_cast<size_t>(clock_source::tsc) + 1;
+    log_clock::time_point now[clocks];
+    bool have_now[clocks] = {};
+    for (auto *msg : batch.ordered) {
+        if (msg->msg_type != async_msg_type::log || msg->worker_ptr == nullptr) {
+            continue;
+        }
+        auto source = msg->worker_ptr->clock();
+        auto c = static_cast<size_t>(source);
+        if (!have_now[c]) {
+            now[c] = clock_now(source);
+            have_now[c] = true;
+        }
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(now[c] - msg->time).count();
+        counts[latency_bucket(ns > 0 ? static_cast<std::uint64_t>(ns) : 0)]++;
+    }
+    for (size_t i = 0; i < async_metrics::latency_buckets; i++) {
+        if (counts[i] != 0) {
+            m.latency_histogram[i].fetch_add(counts[i], std::memory_order_relaxed);
         }
+    }
+}
 
-        case async_msg_type::terminate: {
+// account the time since the end of the previous period as busy or idle
+SPDLOG_INLINE void thread_pool::record_period_(size_t shard, msg_batch &batch, bool busy) {
+    auto now = std::chrono::steady_clock::now();
+    auto ns = static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(now - batch.mark).count());
+    batch.mark = now;
+    (busy ? metrics_[shard].busy_ns : metrics_[shard].idle_ns)
+        .fetch_add(ns, std::memory_order_relaxed);
+}
+
+SPDLOG_INLINE size_t thread_pool::process_batch_(msg_batch &batch) {
+    auto &ordered = batch.ordered;
+    auto &group = batch.group;
+    size_t terminates = 0;
+
+    // format the deferred messages of loggers with a sink that needs the text. the ones that
+    // fail are dropped.
+    size_t kept = 0;
+    async_logger *asked = nullptr;
+    bool needs_payload = true;
+    for (auto *msg : ordered) {
+        if (msg->format_fn != nullptr && msg->msg_type == async_msg_type::log) {
+            if (msg->worker_ptr != asked) {
+                asked = msg->worker_ptr;
+                needs_payload = asked->backend_needs_payload_();
+            }
+            if (!needs_payload) {
+                msg->skip_format();
+            } else if (!asked->backend_format_(*msg)) {
+                continue;
+            }
+        }
+        ordered[kept++] = msg;
+    }
+    ordered.resize(kept);
+    for (size_t i = 0; i < ordered.size();) {
+        auto &incoming_async_msg = *ordered[i];
+        switch (incoming_async_msg.msg_type) {
+            case async_msg_type::log: {
+                auto *worker = incoming_async_msg.worker_ptr;
+                group.clear();
+                for (; i < ordered.size() && ordered[i]->msg_type == async_msg_type::log &&
+                       ordered[i]->worker_ptr == worker;
+                     i++) {
+                    group.push_back(ordered[i]);
+                }
+                if (group.size() == 1) {
+                    worker->backend_sink_it_(*group[0]);
+                } else {
+                    worker->backend_sink_batch_(group.data(), group.size());
+                }
+                continue;
+            }
+            case async_msg_type::flush: {
+                incoming_async_msg.worker_ptr->backend_flush_();
+                break;
+            }
+
+            case async_msg_type::flush_request: {
+                incoming_async_msg.worker_ptr->backend_request_flush_();
+                break;
+            }
+
+            case async_msg_type::release: {
+                handle_release_(incoming_async_msg, batch.worker % queues_.size());
+                break;
+            }
+
+            case async_msg_type::terminate: {
+                terminates++;
+                break;
+            }
+
+            default: {
+                assert(false);
+            }
+        }
+        i++;
+    }
+    return terminates;
+}
+
+//
+// per thread staging rings
+//
+
+// return the calling thread's ring for this pool, creating and registering it on first use.
+SPDLOG_INLINE staging_ring &thread_pool::local_staging_ring_() {
+#ifndef SPDLOG_NO_TLS
+    // the pool owns the rings: an entry only watches its ring, which goes away with the pool.
+    // (the plain pointer is safe while the pool is alive, and only a live pool looks it up.
+    // pool ids are never reused.)
+    struct tls_entry {
+        size_t pool_id;
+        staging_ring *ring;
+        std::weak_ptr<staging_ring> owner;
+    };
+    struct tls_rings {
+        std::vector<tls_entry> entries;
+        ~tls_rings() {
+            for (auto &entry : entries) {
+                if (auto ring = entry.owner.lock()) {
+                    ring->detached.store(true, std::memory_order_release);
+                }
+            }
+        }
+    };
+    static thread_local tls_rings local_rings;
+
+    for (auto &entry : local_rings.entries) {
+        if (entry.pool_id == id_) {
+            return *entry.ring;
+        }
+    }
+
+    // forget the rings of destroyed pools
+    auto &entries = local_rings.entries;
+    entries.erase(std::remove_if(entries.begin(), entries.end(),
+                                 [](const tls_entry &entry) { return entry.owner.expired(); }),
+                  entries.end());
+
+    // (not make_shared, so that the ring's memory is freed with the pool, not with the last
+    // weak reference)
+    staging_ring_ptr ring(new staging_ring(q_max_items_));
+    {
+        std::lock_guard<std::mutex> lock(staging_mutex_);
+        staging_rings_.push_back(ring);
+        staging_version_.fetch_add(1, std::memory_order_release);
+    }
+    entries.push_back(tls_entry{id_, ring.get(), ring});
+    return *ring;
+#else
+    throw_spdlog_ex("thread_pool: per_thread_queues requires thread local storage");
+#endif
+}
+
+SPDLOG_INLINE void thread_pool::post_staging_msg_(async_msg &&new_msg,
+                                                  async_overflow_policy overflow_policy) {
+    if (new_msg.msg_type != async_msg_type::log) {
+        // rings are merged by timestamp, so stamp flush requests too
+        new_msg.time = clock_now(options_.clock);
+    }
+
+    auto &ring = local_staging_ring_();
+    if (!ring.q.try_push(new_msg)) {
+        if (overflow_policy == async_overflow_policy::block) {
+            wake_staging_workers_();
+            auto since = std::chrono::steady_clock::now();
+            auto pushed = [&ring, &new_msg] { return ring.q.try_push(new_msg); };
+            if (!spin_wait(options_.wait, pushed, wait_forever())) {
+                // park mode. the workers wake us after draining (see wake_staging_producers_())
+                std::unique_lock<std::mutex> lock(staging_mutex_);
+                staging_blocked_.fetch_add(1, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                while (!staging_room_cv_.wait_for(lock, std::chrono::milliseconds(100), pushed)) {
+                }
+                staging_blocked_.fetch_sub(1, std::memory_order_relaxed);
+            }
+            if (options_.collect_metrics) {
+                record_blocked_(0, since);
+            }
+        } else if (overflow_policy == async_overflow_policy::overrun_oldest) {
+            while (!ring.q.try_push(new_msg)) {
+                async_msg discarded;
+                if (ring.q.try_pop(discarded)) {
+                    staging_overrun_counter_.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+        } else {
+            assert(overflow_policy == async_overflow_policy::discard_new);
+            staging_discard_counter_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+    }
+    wake_staging_workers_();
+}
+
+// wake parked workers, if any. the fence pairs with the one in staging_worker_loop_().
+SPDLOG_INLINE void thread_pool::wake_staging_workers_() {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (staging_sleepers_.load(std::memory_order_relaxed) != 0) {
+        std::lock_guard<std::mutex> lock(staging_mutex_);
+        staging_cv_.notify_all();
+    }
+}
+
+// wake producers parked on a full ring, if any. the fence pairs with the one in
+// post_staging_msg_().
+SPDLOG_INLINE void thread_pool::wake_staging_producers_() {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (staging_blocked_.load(std::memory_order_relaxed) != 0) {
+        std::lock_guard<std::mutex> lock(staging_mutex_);
+        staging_room_cv_.notify_all();
+    }
+}
+
+SPDLOG_INLINE void thread_pool::staging_worker_loop_() {
+    std::vector<staging_ring_ptr> rings;
+    size_t version = 0;
+    staging_batch batch;
+    batch.mark = std::chrono::steady_clock::now();
+
+    for (;;) {
+        bool stopping = staging_stop_.load(std::memory_order_acquire);
+        refresh_staging_rings_(rings, version);
+        bool drained = drain_staging_rings_(rings, batch);
+        if (retiring_count_.load(std::memory_order_acquire) != 0) {
+            release_retired_from_rings_();
+        }
+        if (options_.collect_metrics) {
+            record_period_(0, batch, drained);
+        }
+        if (drained) {
+            continue;
+        }
+        if (stopping) {
+            return;  // all rings were drained after the stop request
+        }
+        auto has_pending = [this, &rings, &version] {
+            if (staging_stop_.load(std::memory_order_relaxed) ||
+                staging_version_.load(std::memory_order_relaxed) != version ||
+                retiring_count_.load(std::memory_order_relaxed) != 0) {
+                return true;
+            }
+            for (auto &ring : rings) {
+                if (!ring->q.empty()) {
+                    return true;
+                }
+            }
             return false;
+        };
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(100);
+        if (spin_wait(options_.wait, has_pending, deadline) ||
+            options_.wait.mode != wait_mode::park) {
+            if (options_.collect_metrics) {
+                record_period_(0, batch, false);
+            }
+            continue;
         }
 
-        default: {
-            assert(false);
+        std::unique_lock<std::mutex> lock(staging_mutex_);
+        staging_sleepers_.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        staging_cv_.wait_for(lock, std::chrono::milliseconds(100), has_pending);
+        staging_sleepers_.fetch_sub(1, std::memory_order_relaxed);
+        lock.unlock();
+        if (options_.collect_metrics) {
+            record_period_(0, batch, false);
         }
     }
+}
 
-    return true;
+// take a new snapshot of the registered rings if it changed, and release the rings of exited
+// threads once they are empty.
+SPDLOG_INLINE void thread_pool::refresh_staging_rings_(std::vector<staging_ring_ptr> &rings,
+                                                       size_t &version) {
+    auto current = staging_version_.load(std::memory_order_acquire);
+    bool has_detached = false;
+    for (auto &ring : rings) {
+        if (ring->detached.load(std::memory_order_acquire) && ring->q.empty()) {
+            has_detached = true;
+            break;
+        }
+    }
+    if (current == version && !has_detached) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(staging_mutex_);
+    if (has_detached) {
+        auto removed = std::remove_if(
+            staging_rings_.begin(), staging_rings_.end(), [](const staging_ring_ptr &ring) {
+                return ring->detached.load(std::memory_order_acquire) && ring->q.empty();
+            });
+        if (removed != staging_rings_.end()) {
+            staging_rings_.erase(removed, staging_rings_.end());
+            staging_version_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    rings = staging_rings_;
+    version = staging_version_.load(std::memory_order_relaxed);
+}
+
+// a ring is drained past a position once it was popped up to there and no worker is processing
+// the popped messages (taking the ring's draining flag waits for the worker that had it).
+SPDLOG_INLINE void thread_pool::release_retired_from_rings_() {
+    std::vector<async_logger_ptr> released;
+    {
+        std::lock_guard<std::mutex> lock(loggers_mutex_);
+        auto drained = [](const retiring_logger &r) {
+            for (auto &position : r.ring_positions) {
+                auto &ring = *position.first;
+                if (ring.draining.test_and_set(std::memory_order_acquire)) {
+                    return false;
+                }
+                bool passed = ring.q.popped() >= position.second;
+                ring.draining.clear(std::memory_order_release);
+                if (!passed) {
+                    return false;
+                }
+            }
+            return true;
+        };
+        for (auto it = retiring_.begin(); it != retiring_.end();) {
+            if (drained(*it)) {
+                released.push_back(std::move(it->logger));
+                it = retiring_.erase(it);
+                retiring_count_.fetch_sub(1, std::memory_order_relaxed);
+            } else {
+                ++it;
+            }
+        }
+    }
+    // the loggers (and their sinks) are destroyed here, outside the lock
+}
+
+SPDLOG_INLINE bool thread_pool::drain_staging_rings_(const std::vector<staging_ring_ptr> &rings,
+                                                     staging_batch &batch) {
+    auto &msgs = batch.msgs;
+    auto &run_ends = batch.run_ends;
+    auto &heads = batch.heads;
+    bool busy = false;
+    size_t depth = 0;
+    msgs.clear();
+    run_ends.clear();
+    heads.clear();
+    batch.ordered.clear();
+    batch.drained.clear();
+
+    for (auto &ring : rings) {
+        if (ring->q.empty()) {
+            continue;
+        }
+        if (ring->draining.test_and_set(std::memory_order_acquire)) {
+            busy = true;  // another worker is on it
+            continue;
+        }
+        auto run_begin = msgs.size();
+        for (size_t i = 0; i < options_.drain_batch_size; i++) {
+            msgs.emplace_back();
+            if (!ring->q.try_pop(msgs.back())) {
+                msgs.pop_back();
+                break;
+            }
+        }
+        if (msgs.size() == run_begin) {
+            ring->draining.clear(std::memory_order_release);
+            continue;
+        }
+        depth = (std::max)(depth, msgs.size() - run_begin + ring->q.size());
+        heads.push_back(run_begin);
+        run_ends.push_back(msgs.size());
+        batch.drained.push_back(ring.get());
+    }
+
+    // merge the runs by timestamp. each run keeps its own (per thread) order.
+    const auto n_runs = run_ends.size();
+    for (size_t n = 0; n < msgs.size(); n++) {
+        size_t best = n_runs;
+        for (size_t r = 0; r < n_runs; r++) {
+            if (heads[r] < run_ends[r] &&
+                (best == n_runs || msgs[heads[r]].time < msgs[heads[best]].time)) {
+                best = r;
+            }
+        }
+        batch.ordered.push_back(&msgs[heads[best]++]);
+    }
+    if (options_.collect_metrics && !msgs.empty()) {
+        record_batch_(0, batch, depth);
+    }
+    process_batch_(batch);
+    bool processed = !msgs.empty();
+    msgs.clear();
+
+    for (auto *ring : batch.drained) {
+        ring->draining.clear(std::memory_order_release);
+    }
+    if (!batch.drained.empty()) {
+        wake_staging_producers_();
+    }
+    return busy || processed;
 }
 
 }  // namespace details
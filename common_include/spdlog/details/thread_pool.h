@@ -3,16 +3,36 @@
 
 #pragma once
 
-#include <spdlog/details/log_msg_buffer.h>
+#include <spdlog/details/clock.h>
+#include <spdlog/details/deferred_format.h>
+#include <spdlog/details/log_msg.h>
 #include <spdlog/details/mpmc_blocking_q.h>
+#include <spdlog/details/mpmc_lockfree_q.h>
 #include <spdlog/details/os.h>
+#include <spdlog/details/payload_pool.h>
+#include <spdlog/details/spmc_q.h>
+#include <spdlog/details/wait_strategy.h>
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
 #include <functional>
 #include <memory>
+#include <mutex>
+#include <string>
 #include <thread>
+#include <utility>
 #include <vector>
 
+// Size of the inline logger name + payload area of each async queue slot.
+// Larger messages spill into a pooled buffer.
+#ifndef SPDLOG_ASYNC_MSG_INLINE_SIZE
+    #define SPDLOG_ASYNC_MSG_INLINE_SIZE 256
+#endif
+
 namespace spdlog {
 class async_logger;
 
@@ -20,58 +40,267 @@ namespace details {
 
 using async_logger_ptr = std::shared_ptr<spdlog::async_logger>;
 
-enum class async_msg_type { log, flush, terminate };
+// flush_request is the flush asked for by flush_on() or flush_every(), which sinks with a flush
+// policy may hold back (see sink::request_flush()).
+// release is posted to each worker when a logger is dropped (see thread_pool::release_logger()).
+enum class async_msg_type { log, flush, flush_request, release, terminate };
 
 // Async msg to move to/from the queue
 // Movable only. should never be copied
-struct async_msg : log_msg_buffer {
+//
+// The logger name, fields and payload are kept in an inline area of SPDLOG_ASYNC_MSG_INLINE_SIZE bytes,
+// and only larger messages spill into a buffer taken from the payload_pool.
+// worker_ptr doesn't own the logger. the thread pool keeps it alive until it's dropped and its
+// messages are processed (see thread_pool::hold_logger()).
+// If format_fn is set, the payload holds captured arguments that the worker formats with
+// format_deferred() before the message reaches the sinks. The captured arguments are then kept
+// in deferred_args. If no sink needs the text, skip_format() moves them there and leaves the
+// payload empty.
+// The storage holds [logger name][fields][deferred args][payload].
+struct async_msg : log_msg {
     async_msg_type msg_type{async_msg_type::log};
-    async_logger_ptr worker_ptr;
+    async_logger *worker_ptr{nullptr};
+    deferred_format_fn format_fn{nullptr};
+    // release messages: the release they belong to (see thread_pool::release_logger())
+    size_t release_id{0};
 
     async_msg() = default;
-    ~async_msg() = default;
+    ~async_msg() { release_spill_(); }
 
     // should only be moved in or out of the queue..
     async_msg(const async_msg &) = delete;
 
-// support for vs2013 move
-#if defined(_MSC_VER) && _MSC_VER <= 1800
-    async_msg(async_msg &&other)
-        : log_msg_buffer(std::move(other)),
-          msg_type(other.msg_type),
-          worker_ptr(std::move(other.worker_ptr)) {}
-
-    async_msg &operator=(async_msg &&other) {
-        *static_cast<log_msg_buffer *>(this) = std::move(other);
-        msg_type = other.msg_type;
-        worker_ptr = std::move(other.worker_ptr);
+    async_msg(async_msg &&other) SPDLOG_NOEXCEPT : log_msg{other},
+                                                   msg_type{other.msg_type},
+                                                   worker_ptr{other.worker_ptr},
+                                                   format_fn{other.format_fn},
+                                                   release_id{other.release_id} {
+        other.worker_ptr = nullptr;
+        take_storage_(other);
+    }
+
+    async_msg &operator=(async_msg &&other) SPDLOG_NOEXCEPT {
+        if (this != &other) {
+            log_msg::operator=(other);
+            msg_type = other.msg_type;
+            worker_ptr = other.worker_ptr;
+            other.worker_ptr = nullptr;
+            format_fn = other.format_fn;
+            release_id = other.release_id;
+            release_spill_();
+            take_storage_(other);
+        }
         return *this;
     }
-#else  // (_MSC_VER) && _MSC_VER <= 1800
-    async_msg(async_msg &&) = default;
-    async_msg &operator=(async_msg &&) = default;
-#endif
 
     // construct from log_msg with given type
-    async_msg(async_logger_ptr &&worker, async_msg_type the_type, const details::log_msg &m)
-        : log_msg_buffer{m},
+    async_msg(async_logger *worker,
+              async_msg_type the_type,
+              const details::log_msg &m,
+              deferred_format_fn deferred_fn = nullptr)
+        : log_msg{m},
           msg_type{the_type},
-          worker_ptr{std::move(worker)} {}
+          worker_ptr{worker},
+          format_fn{deferred_fn} {
+        auto size = logger_name.size() + fields.size() + payload.size();
+        char *dest = inline_buf_;
+        if (size > sizeof(inline_buf_)) {
+            spill_buf_ = payload_pool::instance().allocate(size, spill_capacity_);
+            dest = spill_buf_;
+        }
+        dest = std::copy(logger_name.begin(), logger_name.end(), dest);
+        dest = std::copy(fields.begin(), fields.end(), dest);
+        std::copy(payload.begin(), payload.end(), dest);
+        // with deferred_fn the payload is the captured call itself
+        deferred_args = string_view_t{};
+        update_string_views_();
+    }
 
-    async_msg(async_logger_ptr &&worker, async_msg_type the_type)
-        : log_msg_buffer{},
-          msg_type{the_type},
-          worker_ptr{std::move(worker)} {}
+    async_msg(async_logger *worker, async_msg_type the_type)
+        : msg_type{the_type},
+          worker_ptr{worker} {}
 
     explicit async_msg(async_msg_type the_type)
         : async_msg{nullptr, the_type} {}
+
+    // format the captured arguments into the payload. they stay available in deferred_args.
+    void format_deferred() {
+        memory_buf_t formatted;
+        format_fn(payload, formatted);
+        format_fn = nullptr;
+
+        auto kept_size = logger_name.size() + fields.size() + payload.size();
+        auto size = kept_size + formatted.size();
+        auto capacity = spill_buf_ != nullptr ? spill_capacity_ : sizeof(inline_buf_);
+        if (size > capacity) {
+            size_t new_capacity = 0;
+            char *buf = payload_pool::instance().allocate(size, new_capacity);
+            std::memcpy(buf, storage_(), kept_size);
+            release_spill_();
+            spill_buf_ = buf;
+            spill_capacity_ = new_capacity;
+        }
+        std::copy(formatted.begin(), formatted.end(), storage_() + kept_size);
+        deferred_args = string_view_t{nullptr, payload.size()};
+        payload = string_view_t{nullptr, formatted.size()};
+        update_string_views_();
+    }
+
+    // keep the captured arguments in deferred_args without formatting them
+    void skip_format() {
+        format_fn = nullptr;
+        deferred_args = string_view_t{nullptr, payload.size()};
+        payload = string_view_t{nullptr, 0};
+        update_string_views_();
+    }
+
+private:
+    char *storage_() { return spill_buf_ != nullptr ? spill_buf_ : inline_buf_; }
+
+    void update_string_views_() {
+        auto *p = storage_();
+        logger_name = string_view_t{p, logger_name.size()};
+        p += logger_name.size();
+        fields = string_view_t{p, fields.size()};
+        p += fields.size();
+        deferred_args = string_view_t{p, deferred_args.size()};
+        p += deferred_args.size();
+        payload = string_view_t{p, payload.size()};
+    }
+
+    // steal the other's spill buffer, or copy its inline bytes. log_msg fields must be set.
+    void take_storage_(async_msg &other) SPDLOG_NOEXCEPT {
+        if (other.spill_buf_ != nullptr) {
+            spill_buf_ = other.spill_buf_;
+            spill_capacity_ = other.spill_capacity_;
+            other.spill_buf_ = nullptr;
+            other.spill_capacity_ = 0;
+        } else {
+            std::memcpy(inline_buf_, other.inline_buf_,
+                        logger_name.size() + fields.size() + deferred_args.size() +
+                            payload.size());
+        }
+        update_string_views_();
+    }
+
+    void release_spill_() SPDLOG_NOEXCEPT {
+        if (spill_buf_ != nullptr) {
+            payload_pool::instance().deallocate(spill_buf_, spill_capacity_);
+            spill_buf_ = nullptr;
+            spill_capacity_ = 0;
+        }
+    }
+
+    char *spill_buf_{nullptr};
+    size_t spill_capacity_{0};
+    char inline_buf_[SPDLOG_ASYNC_MSG_INLINE_SIZE];
+};
+
+// Optional thread pool settings.
+struct thread_pool_options {
+    // Give each producer thread its own staging ring of q_max_items slots instead of posting
+    // into the shared queue. post_log() then never touches memory shared with other producers.
+    // The workers drain the rings round-robin and merge them by message timestamp.
+    // Requires thread local storage (i.e. SPDLOG_NO_TLS must not be defined).
+    bool per_thread_queues = false;
+
+    // Max number of messages a worker takes from the queue (or from one ring) per round.
+    // Consecutive messages of the same logger are handed to its sinks as one batch.
+    // With per_thread_queues this also bounds the reorder window used when merging the rings.
+    size_t drain_batch_size = 64;
+
+    // Give each worker its own queue (shard) of q_max_items slots instead of one queue shared
+    // by all workers. Each async_logger posts to a single shard (see async_logger::set_shard),
+    // so its messages are handled in order by one worker, and the workers never contend with
+    // each other. Can't be combined with per_thread_queues.
+    bool sharded = false;
+
+    // How workers wait for messages and producers wait for room under
+    // async_overflow_policy::block (see details/wait_strategy.h).
+    wait_strategy wait;
+
+    // Collect the counters returned by thread_pool::metrics(). They cost a few clock reads per
+    // batch of messages (and per blocked enqueue), so they can be left on in production.
+    bool collect_metrics = false;
+
+    // Clock of the timestamps taken by the pool, and the default clock of the async loggers
+    // created on it (see async_logger::set_clock and details/clock.h).
+    clock_source clock = clock_source::precise;
+
+    // Worker placement. Each worker applies it to itself before on_thread_start() is called,
+    // and the thread_pool constructor throws spdlog_ex if some setting can't be applied.
+
+    // Pin worker i to cpu_affinity[i % cpu_affinity.size()]. Empty: no pinning.
+    std::vector<int> cpu_affinity;
+
+    // Scheduling policy (e.g. SCHED_BATCH, SCHED_FIFO) and priority of the workers (linux).
+    // -1: keep the inherited policy.
+    int sched_policy = -1;
+    int sched_priority = 0;
+
+    // Nice value of the workers (linux). 0: keep the inherited value.
+    int nice = 0;
+
+    // Allocate the queue from the first worker (each shard from its own worker) after it is
+    // placed, so that the kernel's first touch policy puts the queue memory on that worker's
+    // NUMA node.
+    // (per_thread_queues rings are allocated by their producers and are not affected)
+    bool first_touch_queue = false;
+};
+
+// Metrics of one shard of a thread_pool (or of the whole pool), see thread_pool::metrics().
+struct async_metrics {
+    static const size_t latency_buckets = 64;
+
+    // max queue depth seen by the workers when taking messages
+    // (with per_thread_queues: the max depth of a single ring)
+    size_t queue_high_water = 0;
+
+    // enqueues that had to wait for room under async_overflow_policy::block, and for how long
+    std::uint64_t blocked_count = 0;
+    std::chrono::nanoseconds blocked_total{0};
+    std::chrono::nanoseconds blocked_max{0};
+
+    // latency_histogram[i] counts the messages that took [2^i, 2^(i+1)) ns from the log call
+    // until a worker took them off the queue for the sinks (bucket 0 also counts 0 ns)
+    std::uint64_t latency_histogram[latency_buckets] = {};
+
+    // time the workers spent processing messages and waiting for them
+    std::chrono::nanoseconds busy{0};
+    std::chrono::nanoseconds idle{0};
+
+    double busy_ratio() const {
+        auto total = busy + idle;
+        return total.count() > 0 ? static_cast<double>(busy.count()) / total.count() : 0.0;
+    }
+};
+
+// Per producer staging ring (see thread_pool_options::per_thread_queues).
+struct staging_ring {
+    explicit staging_ring(size_t max_items)
+        : q(max_items) {}
+
+    spmc_queue<async_msg> q;
+    // held by the worker currently draining this ring, to keep the ring's messages in order
+    std::atomic_flag draining = ATOMIC_FLAG_INIT;
+    // set when the producer thread exits. the ring is released once drained.
+    std::atomic<bool> detached{false};
 };
 
 class SPDLOG_API thread_pool {
 public:
     using item_type = async_msg;
+#ifdef SPDLOG_ASYNC_LOCKFREE_QUEUE
+    using q_type = details::mpmc_lockfree_queue<item_type>;
+#else
     using q_type = details::mpmc_blocking_queue<item_type>;
+#endif
 
+    thread_pool(size_t q_max_items,
+                size_t threads_n,
+                std::function<void()> on_thread_start,
+                std::function<void()> on_thread_stop,
+                const thread_pool_options &options);
     thread_pool(size_t q_max_items,
                 size_t threads_n,
                 std::function<void()> on_thread_start,
@@ -85,28 +314,160 @@ public:
     thread_pool(const thread_pool &) = delete;
     thread_pool &operator=(thread_pool &&) = delete;
 
-    void post_log(async_logger_ptr &&worker_ptr,
+    void post_log(async_logger *worker_ptr,
                   const details::log_msg &msg,
-                  async_overflow_policy overflow_policy);
-    void post_flush(async_logger_ptr &&worker_ptr, async_overflow_policy overflow_policy);
+                  async_overflow_policy overflow_policy,
+                  deferred_format_fn format_fn = nullptr);
+    void post_flush(async_logger *worker_ptr, async_overflow_policy overflow_policy);
+    void post_flush_request(async_logger *worker_ptr, async_overflow_policy overflow_policy);
+    // keep the logger alive until it's released. called by the logger before it first posts
+    // to this pool, so posting doesn't touch the logger's reference count.
+    void hold_logger(async_logger_ptr &&worker_ptr);
+    // drop the reference taken by hold_logger() once the messages the logger posted so far
+    // are processed. a release message is posted to each worker behind them: once one was
+    // taken from each queue, the logger is released by the last worker to finish the batch it
+    // was on (idle workers check every 100ms). with per_thread_queues the logger is released
+    // once every ring was drained past the position it had when the logger was dropped.
+    void release_logger(async_logger *worker_ptr);
     size_t overrun_counter();
     void reset_overrun_counter();
     size_t discard_counter();
     void reset_discard_counter();
     size_t queue_size();
+    // number of queues: threads_n if sharded, 1 otherwise
+    size_t shard_count() const;
+    clock_source clock() const;
+
+    // metrics of the given shard (requires thread_pool_options::collect_metrics)
+    async_metrics metrics(size_t shard) const;
+    // metrics of the whole pool: the counters are summed, the maxima are the max of the shards
+    async_metrics metrics() const;
+    void reset_metrics();
 
 private:
-    q_type q_;
+    using staging_ring_ptr = std::shared_ptr<staging_ring>;
+
+    // scratch buffers reused by a worker between rounds
+    struct msg_batch {
+        std::vector<async_msg> msgs;
+        std::vector<async_msg *> ordered;
+        std::vector<const log_msg *> group;
+        // index of the worker using the batch
+        size_t worker = 0;
+        // end of the last busy or idle period of the worker (collect_metrics only)
+        std::chrono::steady_clock::time_point mark;
+    };
+
+    // scratch buffers reused by a worker between drain rounds (staging mode)
+    struct staging_batch : msg_batch {
+        std::vector<size_t> heads;
+        std::vector<size_t> run_ends;
+        std::vector<staging_ring *> drained;
+    };
+
+    thread_pool_options options_;
+    size_t q_max_items_;
+    std::vector<std::unique_ptr<q_type>> queues_;
 
     std::vector<std::thread> threads_;
 
+    // live counters behind async_metrics, one per shard
+    struct shard_metrics {
+        shard_metrics() { reset(); }
+        void reset();
+        std::atomic<size_t> queue_high_water;
+        std::atomic<std::uint64_t> blocked_count;
+        std::atomic<std::uint64_t> blocked_ns;
+        std::atomic<std::uint64_t> blocked_max_ns;
+        std::atomic<std::uint64_t> latency_histogram[async_metrics::latency_buckets];
+        std::atomic<std::uint64_t> busy_ns;
+        std::atomic<std::uint64_t> idle_ns;
+    };
+    std::unique_ptr<shard_metrics[]> metrics_;
+
+    // per thread staging rings (only used with thread_pool_options::per_thread_queues)
+    size_t id_;
+    std::mutex staging_mutex_;
+    std::vector<staging_ring_ptr> staging_rings_;
+    std::atomic<size_t> staging_version_{0};
+    std::atomic<bool> staging_stop_{false};
+    std::atomic<size_t> staging_sleepers_{0};
+    std::condition_variable staging_cv_;
+    // producers parked on a full ring (async_overflow_policy::block), woken by the workers
+    std::atomic<size_t> staging_blocked_{0};
+    std::condition_variable staging_room_cv_;
+    std::atomic<size_t> staging_overrun_counter_{0};
+    std::atomic<size_t> staging_discard_counter_{0};
+
+    // loggers that posted to this pool (see hold_logger()), and dropped loggers waiting for
+    // their messages to be processed (see release_logger())
+    struct retiring_logger {
+        size_t id = 0;
+        async_logger_ptr logger;
+        // the queues its release message was taken from, and the workers that finished a batch
+        // since then
+        std::vector<bool> seen_in;
+        std::vector<bool> released_by;
+        size_t pending_workers = 0;
+        // per_thread_queues: each ring with its push position when the logger was dropped
+        std::vector<std::pair<staging_ring_ptr, size_t>> ring_positions;
+    };
+    std::mutex loggers_mutex_;
+    std::vector<async_logger_ptr> held_loggers_;
+    std::vector<retiring_logger> retiring_;
+    std::atomic<size_t> retiring_count_{0};
+    size_t last_release_id_ = 0;
+
+    // workers wait here until all of them are placed (see thread_pool_options)
+    struct start_gate {
+        std::mutex mutex;
+        std::condition_variable cv;
+        size_t ready = 0;
+        bool released = false;
+        std::string error;
+        int error_errno = 0;
+    };
+
+    // apply the placement options to the calling worker (and allocate its queue with
+    // first_touch_queue). return false and set error/error_errno on failure.
+    bool place_worker_(size_t index, std::string &error, int &error_errno);
+
     void post_async_msg_(async_msg &&new_msg, async_overflow_policy overflow_policy);
-    void worker_loop_();
+    size_t shard_of_(const async_logger *worker_ptr) const;
+    q_type &queue_of_(const async_logger *worker_ptr);
+    void worker_loop_(size_t worker, size_t shard);
+    // note that a release message was taken from the given queue
+    void handle_release_(const async_msg &msg, size_t shard);
+    // called by a worker between batches: release the dropped loggers whose release messages
+    // were taken from all the queues and that every worker finished a batch since
+    void release_retired_(size_t worker);
+    // staging mode: release the dropped loggers whose messages were all processed
+    void release_retired_from_rings_();
 
-    // process next message in the queue
+    // metrics
+    void record_blocked_(size_t shard, std::chrono::steady_clock::time_point since);
+    void record_batch_(size_t shard, const msg_batch &batch, size_t depth);
+    void record_period_(size_t shard, msg_batch &batch, bool busy);
+
+    // process next batch of messages in the queue
     // return true if this thread should still be active (while no terminate msg
     // was received)
-    bool process_next_msg_();
+    bool process_next_batch_(size_t shard, msg_batch &batch);
+
+    // handle batch.ordered in order. consecutive log messages of the same logger are passed to
+    // its sinks with a single call. return the number of terminate messages seen.
+    size_t process_batch_(msg_batch &batch);
+
+    // staging mode
+    staging_ring &local_staging_ring_();
+    void post_staging_msg_(async_msg &&new_msg, async_overflow_policy overflow_policy);
+    void wake_staging_workers_();
+    void wake_staging_producers_();
+    void staging_worker_loop_();
+    void refresh_staging_rings_(std::vector<staging_ring_ptr> &rings, size_t &version);
+    // drain up to drain_batch_size messages from each ring and process them merged by timestamp.
+    // return true if any message was processed or some ring was busy with another worker.
+    bool drain_staging_rings_(const std::vector<staging_ring_ptr> &rings, staging_batch &batch);
 };
 
 }  // namespace details
@@ -0,0 +1,98 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// How the async queues wait for room (producers, under async_overflow_policy::block) or for
+// messages (workers). Selected per thread pool with thread_pool_options::wait.
+//
+// Every mode first spins for spin_count pause iterations. Then:
+//   park      - block on a condition variable until woken (default). idle threads cost nothing,
+//               but every handoff to a parked thread is a futex wake and a context switch.
+//   busy_spin - keep spinning. lowest handoff latency, burns a core per waiting thread.
+//   yield     - yield the cpu between checks. never sleeps in the kernel.
+//   backoff   - sleep between checks, doubling the delay from 1us up to max_backoff.
+// Only park mode makes the other side pay for a wake up.
+
+#include <spdlog/common.h>
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+    #include <intrin.h>
+#endif
+
+namespace spdlog {
+namespace details {
+
+enum class wait_mode { park, busy_spin, yield, backoff };
+
+struct wait_strategy {
+    wait_mode mode = wait_mode::park;
+    unsigned spin_count = 256;
+    std::chrono::microseconds max_backoff{1000};
+};
+
+// hint the cpu that we are in a spin-wait loop
+inline void cpu_relax() SPDLOG_NOEXCEPT {
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+    _mm_pause();
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__i386__) || defined(__x86_64__))
+    __builtin_ia32_pause();
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__aarch64__) || defined(__arm__))
+    __asm__ __volatile__("yield");
+#endif
+}
+
+// wait until ready() returns true, without blocking in the kernel.
+// in park mode give up after spin_count iterations, so the caller can park. in the other modes
+// give up only when the deadline has passed.
+// return true if ready() returned true.
+template <typename Ready>
+bool spin_wait(const wait_strategy &strategy,
+               Ready ready,
+               std::chrono::steady_clock::time_point deadline) {
+    for (unsigned i = 0; i < strategy.spin_count; i++) {
+        if (ready()) {
+            return true;
+        }
+        cpu_relax();
+    }
+    if (strategy.mode == wait_mode::park) {
+        return ready();
+    }
+
+    std::chrono::microseconds backoff{1};
+    for (unsigned i = 0;; i++) {
+        if (ready()) {
+            return true;
+        }
+        // reading the clock costs more than a pause, so busy_spin checks it once in a while
+        if ((strategy.mode != wait_mode::busy_spin || i % 64 == 0) &&
+            std::chrono::steady_clock::now() >= deadline) {
+            return false;
+        }
+        switch (strategy.mode) {
+            case wait_mode::busy_spin:
+                cpu_relax();
+                break;
+            case wait_mode::yield:
+                std::this_thread::yield();
+                break;
+            default:
+                std::this_thread::sleep_for(backoff);
+                backoff = (std::min)(backoff * 2, strategy.max_backoff);
+                break;
+        }
+    }
+}
+
+// deadline of a wait without timeout
+inline std::chrono::steady_clock::time_point wait_forever() {
+    return std::chrono::steady_clock::time_point::max();
+}
+
+}  // namespace details
+}  // namespace spdlog
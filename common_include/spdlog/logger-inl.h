@@ -22,7 +22,9 @@ SPDLOG_INLINE logger::logger(const logger &other)
       level_(other.level_.load(std::memory_order_relaxed)),
       flush_level_(other.flush_level_.load(std::memory_order_relaxed)),
       custom_err_handler_(other.custom_err_handler_),
-      tracer_(other.tracer_) {}
+      tracer_(other.tracer_),
+      deferred_format_(other.deferred_format_.load(std::memory_order_relaxed)),
+      clock_(other.clock_.load(std::memory_order_relaxed)) {}
 
 SPDLOG_INLINE logger::logger(logger &&other) SPDLOG_NOEXCEPT
     : name_(std::move(other.name_)),
@@ -30,7 +32,9 @@ SPDLOG_INLINE logger::logger(logger &&other) SPDLOG_NOEXCEPT
       level_(other.level_.load(std::memory_order_relaxed)),
       flush_level_(other.flush_level_.load(std::memory_order_relaxed)),
       custom_err_handler_(std::move(other.custom_err_handler_)),
-      tracer_(std::move(other.tracer_))
+      tracer_(std::move(other.tracer_)),
+      deferred_format_(other.deferred_format_.load(std::memory_order_relaxed)),
+      clock_(other.clock_.load(std::memory_order_relaxed))
 
 {}
 
@@ -55,6 +59,12 @@ SPDLOG_INLINE void logger::swap(spdlog::logger &other) SPDLOG_NOEXCEPT {
 
     custom_err_handler_.swap(other.custom_err_handler_);
     std::swap(tracer_, other.tracer_);
+
+    auto other_deferred = other.deferred_format_.load();
+    other.deferred_format_.store(deferred_format_.exchange(other_deferred));
+
+    auto other_clock = other.clock_.load();
+    other.clock_.store(clock_.exchange(other_clock));
 }
 
 SPDLOG_INLINE void swap(logger &a, logger &b) noexcept { a.swap(b); }
@@ -65,6 +75,14 @@ SPDLOG_INLINE level::level_enum logger::level() const {
     return static_cast<level::level_enum>(level_.load(std::memory_order_relaxed));
 }
 
+SPDLOG_INLINE void logger::set_clock(clock_source source) {
+    clock_.store(source, std::memory_order_relaxed);
+}
+
+SPDLOG_INLINE clock_source logger::clock() const {
+    return clock_.load(std::memory_order_relaxed);
+}
+
 SPDLOG_INLINE const std::string &logger::name() const { return name_; }
 
 // set formatting for the sinks in this logger.
@@ -97,6 +115,8 @@ SPDLOG_INLINE void logger::dump_backtrace() { dump_backtrace_(); }
 // flush functions
 SPDLOG_INLINE void logger::flush() { flush_(); }
 
+SPDLOG_INLINE void logger::request_flush() { request_flush_(); }
+
 SPDLOG_INLINE void logger::flush_on(level::level_enum log_level) { flush_level_.store(log_level); }
 
 SPDLOG_INLINE level::level_enum logger::flush_level() const {
@@ -120,6 +140,8 @@ SPDLOG_INLINE std::shared_ptr<logger> logger::clone(std::string logger_name) {
     return cloned;
 }
 
+SPDLOG_INLINE void logger::on_drop() {}
+
 // protected methods
 SPDLOG_INLINE void logger::log_it_(const spdlog::details::log_msg &log_msg,
                                    bool log_enabled,
@@ -133,18 +155,37 @@ SPDLOG_INLINE void logger::log_it_(const spdlog::details::log_msg &log_msg,
 }
 
 SPDLOG_INLINE void logger::sink_it_(const details::log_msg &msg) {
-    for (auto &sink : sinks_) {
-        if (sink->should_log(msg.level)) {
-            SPDLOG_TRY { sink->log(msg); }
+    if (sinks_.size() == 1) {
+        if (sinks_[0]->should_log(msg.level)) {
+            SPDLOG_TRY { sinks_[0]->log(msg); }
             SPDLOG_LOGGER_CATCH(msg.source)
         }
+    } else {
+        // sinks with the same format share the formatted message
+        details::shared_format shared;
+        for (auto &sink : sinks_) {
+            if (sink->should_log(msg.level)) {
+                SPDLOG_TRY { sink->log_formatted(msg, shared); }
+                SPDLOG_LOGGER_CATCH(msg.source)
+            }
+        }
     }
 
     if (should_flush_(msg)) {
-        flush_();
+        request_flush_();
     }
 }
 
+SPDLOG_INLINE void logger::sink_deferred_(const details::log_msg &msg,
+                                          details::deferred_format_fn format_fn) {
+    memory_buf_t buf;
+    format_fn(msg.payload, buf);
+    details::log_msg formatted(msg);
+    formatted.payload = string_view_t(buf.data(), buf.size());
+    formatted.deferred_args = msg.payload;
+    sink_it_(formatted);
+}
+
 SPDLOG_INLINE void logger::flush_() {
     for (auto &sink : sinks_) {
         SPDLOG_TRY { sink->flush(); }
@@ -152,6 +193,13 @@ SPDLOG_INLINE void logger::flush_() {
     }
 }
 
+SPDLOG_INLINE void logger::request_flush_() {
+    for (auto &sink : sinks_) {
+        SPDLOG_TRY { sink->request_flush(); }
+        SPDLOG_LOGGER_CATCH(source_loc())
+    }
+}
+
 SPDLOG_INLINE void logger::dump_backtrace_() {
     using details::log_msg;
     if (tracer_.enabled() && !tracer_.empty()) {
@@ -16,6 +16,9 @@
 
 #include <spdlog/common.h>
 #include <spdlog/details/backtracer.h>
+#include <spdlog/details/clock.h>
+#include <spdlog/details/deferred_format.h>
+#include <spdlog/details/fields.h>
 #include <spdlog/details/log_msg.h>
 
 #ifdef SPDLOG_WCHAR_TO_UTF8_SUPPORT
@@ -119,12 +122,73 @@ public:
             return;
         }
 
-        details::log_msg log_msg(loc, name_, lvl, msg);
+        details::log_msg log_msg(now_(), loc, name_, lvl, msg);
         log_it_(log_msg, log_enabled, traceback_enabled);
     }
 
     void log(level::level_enum lvl, string_view_t msg) { log(source_loc{}, lvl, msg); }
 
+    // log msg with structured fields, e.g. log(level::info, "done", kv("user_id", id)).
+    // the fields are stored typed with the message, see details/fields.h.
+    template <typename T, typename... Fields>
+    void log(source_loc loc,
+             level::level_enum lvl,
+             string_view_t msg,
+             kv_field<T> field,
+             kv_field<Fields>... fields) {
+        bool log_enabled = should_log(lvl);
+        bool traceback_enabled = tracer_.enabled();
+        if (!log_enabled && !traceback_enabled) {
+            return;
+        }
+        SPDLOG_TRY {
+            memory_buf_t buf;
+            details::encode_fields(buf, field, fields...);
+            details::log_msg log_msg(now_(), loc, name_, lvl, msg);
+            log_msg.fields = string_view_t(buf.data(), buf.size());
+            log_it_(log_msg, log_enabled, traceback_enabled);
+        }
+        SPDLOG_LOGGER_CATCH(loc)
+    }
+
+    template <typename T, typename... Fields>
+    void log(level::level_enum lvl,
+             string_view_t msg,
+             kv_field<T> field,
+             kv_field<Fields>... fields) {
+        log(source_loc{}, lvl, msg, field, fields...);
+    }
+
+    template <typename T, typename... Fields>
+    void trace(string_view_t msg, kv_field<T> field, kv_field<Fields>... fields) {
+        log(level::trace, msg, field, fields...);
+    }
+
+    template <typename T, typename... Fields>
+    void debug(string_view_t msg, kv_field<T> field, kv_field<Fields>... fields) {
+        log(level::debug, msg, field, fields...);
+    }
+
+    template <typename T, typename... Fields>
+    void info(string_view_t msg, kv_field<T> field, kv_field<Fields>... fields) {
+        log(level::info, msg, field, fields...);
+    }
+
+    template <typename T, typename... Fields>
+    void warn(string_view_t msg, kv_field<T> field, kv_field<Fields>... fields) {
+        log(level::warn, msg, field, fields...);
+    }
+
+    template <typename T, typename... Fields>
+    void error(string_view_t msg, kv_field<T> field, kv_field<Fields>... fields) {
+        log(level::err, msg, field, fields...);
+    }
+
+    template <typename T, typename... Fields>
+    void critical(string_view_t msg, kv_field<T> field, kv_field<Fields>... fields) {
+        log(level::critical, msg, field, fields...);
+    }
+
     template <typename... Args>
     void trace(format_string_t<Args...> fmt, Args &&...args) {
         log(level::trace, fmt, std::forward<Args>(args)...);
@@ -191,7 +255,7 @@ public:
 
         memory_buf_t buf;
         details::os::wstr_to_utf8buf(wstring_view_t(msg.data(), msg.size()), buf);
-        details::log_msg log_msg(loc, name_, lvl, string_view_t(buf.data(), buf.size()));
+        details::log_msg log_msg(now_(), loc, name_, lvl, string_view_t(buf.data(), buf.size()));
         log_it_(log_msg, log_enabled, traceback_enabled);
     }
 
@@ -270,6 +334,10 @@ public:
 
     level::level_enum level() const;
 
+    // clock of the message timestamps (see details/clock.h)
+    void set_clock(clock_source source);
+    clock_source clock() const;
+
     const std::string &name() const;
 
     // set formatting for the sinks in this logger.
@@ -290,6 +358,9 @@ public:
 
     // flush functions
     void flush();
+    // the flush done when a message reaches the flush_on() level, and by flush_every(). sinks
+    // with a flush policy may hold it back, flush() always flushes.
+    void request_flush();
     void flush_on(level::level_enum log_level);
     level::level_enum flush_level() const;
 
@@ -304,6 +375,11 @@ public:
     // create new logger with same sinks and configuration.
     virtual std::shared_ptr<logger> clone(std::string logger_name);
 
+    // called by the registry when the logger is dropped (see spdlog::drop). async loggers then
+    // let their thread pool release them. call it for an async logger that isn't registered
+    // once done logging with it, or the pool keeps it until the pool is destroyed.
+    virtual void on_drop();
+
 protected:
     std::string name_;
     std::vector<sink_ptr> sinks_;
@@ -311,6 +387,13 @@ protected:
     spdlog::level_t flush_level_{level::off};
     err_handler custom_err_handler_{nullptr};
     details::backtracer tracer_;
+    // capture the arguments and let sink_deferred_() format them later, when possible
+    std::atomic<bool> deferred_format_{false};
+    std::atomic<clock_source> clock_{clock_source::precise};
+
+    log_clock::time_point now_() const {
+        return details::clock_now(clock_.load(std::memory_order_relaxed));
+    }
 
     // common implementation for after templated public api has been resolved
     template <typename... Args>
@@ -321,6 +404,10 @@ protected:
             return;
         }
         SPDLOG_TRY {
+            if (!traceback_enabled && deferred_format_.load(std::memory_order_relaxed) &&
+                log_deferred_(details::is_deferrable<Args...>{}, loc, lvl, fmt, args...)) {
+                return;
+            }
             memory_buf_t buf;
 #ifdef SPDLOG_USE_STD_FORMAT
             fmt_lib::vformat_to(std::back_inserter(buf), fmt, fmt_lib::make_format_args(args...));
@@ -328,12 +415,28 @@ protected:
             fmt::vformat_to(fmt::appender(buf), fmt, fmt::make_format_args(args...));
 #endif
 
-            details::log_msg log_msg(loc, name_, lvl, string_view_t(buf.data(), buf.size()));
+            details::log_msg log_msg(now_(), loc, name_, lvl, string_view_t(buf.data(), buf.size()));
             log_it_(log_msg, log_enabled, traceback_enabled);
         }
         SPDLOG_LOGGER_CATCH(loc)
     }
 
+    template <typename... Args>
+    bool log_deferred_(std::false_type, source_loc, level::level_enum, string_view_t, Args &...) {
+        return false;
+    }
+
+    template <typename... Args>
+    bool log_deferred_(
+        std::true_type, source_loc loc, level::level_enum lvl, string_view_t fmt, Args &...args) {
+        memory_buf_t blob;
+        details::encode_deferred(blob, fmt, args...);
+        details::log_msg log_msg(now_(), loc, name_, lvl, string_view_t(blob.data(), blob.size()));
+        sink_deferred_(log_msg,
+                       &details::deferred_formatter<typename std::decay<Args>::type...>::format);
+        return true;
+    }
+
 #ifdef SPDLOG_WCHAR_TO_UTF8_SUPPORT
     template <typename... Args>
     void log_(source_loc loc, level::level_enum lvl, wstring_view_t fmt, Args &&...args) {
@@ -350,7 +453,7 @@ protected:
 
             memory_buf_t buf;
             details::os::wstr_to_utf8buf(wstring_view_t(wbuf.data(), wbuf.size()), buf);
-            details::log_msg log_msg(loc, name_, lvl, string_view_t(buf.data(), buf.size()));
+            details::log_msg log_msg(now_(), loc, name_, lvl, string_view_t(buf.data(), buf.size()));
             log_it_(log_msg, log_enabled, traceback_enabled);
         }
         SPDLOG_LOGGER_CATCH(loc)
@@ -361,7 +464,11 @@ protected:
     // and save backtrace (if backtrace is enabled).
     void log_it_(const details::log_msg &log_msg, bool log_enabled, bool traceback_enabled);
     virtual void sink_it_(const details::log_msg &msg);
+    // msg.payload holds the captured format string and arguments, to be formatted with format_fn.
+    // the default implementation formats it right away.
+    virtual void sink_deferred_(const details::log_msg &msg, details::deferred_format_fn format_fn);
     virtual void flush_();
+    virtual void request_flush_();
     void dump_backtrace_();
     bool should_flush_(const details::log_msg &msg) const;
 
@@ -7,12 +7,18 @@
     #error "This header requires thread local storage support, but SPDLOG_NO_TLS is defined."
 #endif
 
-#include <map>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <mutex>
 #include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include <spdlog/common.h>
 
-// MDC is a simple map of key->string values stored in thread local storage whose content will be
+// MDC is a set of key->string values stored in thread local storage whose content will be
 // printed by the loggers. Note: Not supported in async mode (thread local storage - so the async
 // thread pool have different copy).
 //
@@ -20,33 +26,286 @@
 // spdlog::mdc::put("mdc_key_1", "mdc_value_1");
 // spdlog::info("Hello, {}", "World!");  // => [2024-04-26 02:08:05.040] [info]
 // [mdc_key_1:mdc_value_1] Hello, World!
+//
+// Keys are interned once into a process wide registry, and each thread caches the keys it has
+// used, so only the first use of a key in a thread takes the registry lock. Interned keys are
+// never freed: use a fixed set of keys, not keys built at runtime (e.g. with ids in them), or
+// the registry grows without bound. get() and remove() by name never intern.
+// Code that sets the context often can register its keys up front and use the ids, which also
+// skips the per thread lookup:
+//
+// static const auto request_id = spdlog::mdc::register_key("request_id");
+// spdlog::mdc::scoped_put guard(request_id, id);  // removed (or restored) at end of scope
+//
+// Each thread keeps its entries in a flat vector sorted by key, with short values stored inline,
+// and the rendered "key:value key:value" text, which is only rebuilt after a change.
 
 namespace spdlog {
+namespace details {
+
+// value of an mdc entry. short values are stored inline.
+class mdc_value {
+public:
+    static const size_t inline_size = 48;
+
+    mdc_value() = default;
+    mdc_value(const mdc_value &other) { assign(other.view()); }
+    mdc_value &operator=(const mdc_value &other) {
+        if (this != &other) {
+            assign(other.view());
+        }
+        return *this;
+    }
+
+    void assign(string_view_t value) {
+        size_ = value.size();
+        if (size_ <= inline_size) {
+            std::memcpy(inline_, value.data(), size_);
+        } else {
+            spill_.assign(value.data(), value.size());
+        }
+    }
+
+    string_view_t view() const {
+        return size_ <= inline_size ? string_view_t{inline_, size_}
+                                    : string_view_t{spill_.data(), spill_.size()};
+    }
+
+private:
+    size_t size_{0};
+    char inline_[inline_size];
+    std::string spill_;
+};
+
+// process wide key registry. ids are never reused, names are never freed.
+class mdc_registry {
+public:
+    static mdc_registry &instance() {
+        static mdc_registry registry;
+        return registry;
+    }
+
+    std::uint32_t register_key(string_view_t key) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::string name(key.data(), key.size());
+        auto it = ids_.find(name);
+        if (it != ids_.end()) {
+            return it->second;
+        }
+        auto id = static_cast<std::uint32_t>(names_.size());
+        names_.push_back(std::move(name));
+        ids_.emplace(names_.back(), id);
+        return id;
+    }
+
+    const std::string &name(std::uint32_t id) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return names_[id];
+    }
+
+private:
+    std::mutex mutex_;
+    std::deque<std::string> names_;  // deque: the names don't move
+    std::unordered_map<std::string, std::uint32_t> ids_;
+};
+
+// the mdc entries of one thread
+class mdc_context {
+public:
+    struct entry {
+        std::uint32_t key;
+        const std::string *name;
+        mdc_value value;
+    };
+
+    bool empty() const { return entries_.empty(); }
+    const std::vector<entry> &entries() const { return entries_; }
+
+    const entry *find(std::uint32_t key) const {
+        for (auto &e : entries_) {
+            if (e.key == key) {
+                return &e;
+            }
+        }
+        return nullptr;
+    }
+
+    const entry *find(const std::string &name) const {
+        for (auto &e : entries_) {
+            if (*e.name == name) {
+                return &e;
+            }
+        }
+        return nullptr;
+    }
+
+    // id of key, from the cache of this thread. only a miss takes the registry lock.
+    std::uint32_t key_id(const std::string &key) {
+        auto it = key_ids_.find(key);
+        if (it != key_ids_.end()) {
+            return it->second;
+        }
+        auto id = mdc_registry::instance().register_key(key);
+        key_ids_.emplace(key, id);
+        return id;
+    }
+
+    void put(std::uint32_t key, string_view_t value) {
+        dirty_ = true;
+        for (auto &e : entries_) {
+            if (e.key == key) {
+                e.value.assign(value);
+                return;
+            }
+        }
+        // keep the entries sorted by name
+        const std::string *name = &key_name_(key);
+        auto it = entries_.begin();
+        while (it != entries_.end() && *it->name < *name) {
+            ++it;
+        }
+        it = entries_.insert(it, entry{key, name, mdc_value{}});
+        it->value.assign(value);
+    }
+
+    void remove(std::uint32_t key) {
+        for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+            if (it->key == key) {
+                entries_.erase(it);
+                dirty_ = true;
+                return;
+            }
+        }
+    }
+
+    void clear() {
+        dirty_ = dirty_ || !entries_.empty();
+        entries_.clear();
+    }
+
+    // "key:value key:value", rebuilt only after a change
+    string_view_t rendered() {
+        if (dirty_) {
+            rendered_.clear();
+            for (auto &e : entries_) {
+                if (!rendered_.empty()) {
+                    rendered_.push_back(' ');
+                }
+                rendered_.append(*e.name);
+                rendered_.push_back(':');
+                auto value = e.value.view();
+                rendered_.append(value.data(), value.size());
+            }
+            dirty_ = false;
+        }
+        return string_view_t{rendered_.data(), rendered_.size()};
+    }
+
+private:
+    const std::string &key_name_(std::uint32_t key) {
+        if (key >= key_names_.size()) {
+            key_names_.resize(key + 1, nullptr);
+        }
+        if (key_names_[key] == nullptr) {
+            key_names_[key] = &mdc_registry::instance().name(key);
+        }
+        return *key_names_[key];
+    }
+
+    std::vector<entry> entries_;
+    std::string rendered_;
+    bool dirty_{false};
+
+    // registry lookups of this thread
+    std::unordered_map<std::string, std::uint32_t> key_ids_;
+    std::vector<const std::string *> key_names_;
+};
+
+}  // namespace details
+
 class SPDLOG_API mdc {
 public:
-    using mdc_map_t = std::map<std::string, std::string>;
+    using key_id = std::uint32_t;
+
+    // intern key and return its id. ids are valid in all threads for the life of the process.
+    static key_id register_key(string_view_t key) {
+        return details::mdc_registry::instance().register_key(key);
+    }
+
+    static void put(key_id key, string_view_t value) { get_context().put(key, value); }
 
     static void put(const std::string &key, const std::string &value) {
-        get_context()[key] = value;
+        auto &context = get_context();
+        context.put(context.key_id(key), value);
+    }
+
+    static std::string get(key_id key) {
+        auto *e = get_context().find(key);
+        if (e == nullptr) {
+            return "";
+        }
+        auto value = e->value.view();
+        return std::string(value.data(), value.size());
     }
 
     static std::string get(const std::string &key) {
-        auto &context = get_context();
-        auto it = context.find(key);
-        if (it != context.end()) {
-            return it->second;
+        auto *e = get_context().find(key);
+        if (e == nullptr) {
+            return "";
         }
-        return "";
+        auto value = e->value.view();
+        return std::string(value.data(), value.size());
     }
 
-    static void remove(const std::string &key) { get_context().erase(key); }
+    static void remove(key_id key) { get_context().remove(key); }
+
+    static void remove(const std::string &key) {
+        auto *e = get_context().find(key);
+        if (e != nullptr) {
+            remove(e->key);
+        }
+    }
 
     static void clear() { get_context().clear(); }
 
-    static mdc_map_t &get_context() {
-        static thread_local mdc_map_t context;
+    static details::mdc_context &get_context() {
+        static thread_local details::mdc_context context;
         return context;
     }
+
+    // put a value for the lifetime of the guard. the previous value of the key (if any) is
+    // restored when the guard is destroyed.
+    class scoped_put {
+    public:
+        scoped_put(key_id key, string_view_t value)
+            : key_(key) {
+            auto *e = get_context().find(key);
+            had_previous_ = e != nullptr;
+            if (had_previous_) {
+                previous_ = e->value;
+            }
+            get_context().put(key, value);
+        }
+
+        scoped_put(const std::string &key, string_view_t value)
+            : scoped_put(get_context().key_id(key), value) {}
+
+        ~scoped_put() {
+            if (had_previous_) {
+                get_context().put(key_, previous_.view());
+            } else {
+                get_context().remove(key_);
+            }
+        }
+
+        scoped_put(const scoped_put &) = delete;
+        scoped_put &operator=(const scoped_put &) = delete;
+
+    private:
+        key_id key_;
+        bool had_previous_;
+        details::mdc_value previous_;
+    };
 };
 
 }  // namespace spdlog
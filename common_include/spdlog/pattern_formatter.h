@@ -80,6 +80,7 @@ public:
 
     std::unique_ptr<formatter> clone() const override;
     void format(const details::log_msg &msg, memory_buf_t &dest) override;
+    std::string output_key() const override;
 
     template <typename T, typename... Args>
     pattern_formatter &add_flag(char flag, Args &&...args) {
@@ -98,6 +99,7 @@ private:
     std::chrono::seconds last_log_secs_;
     std::vector<std::unique_ptr<details::flag_formatter>> formatters_;
     custom_flags custom_handlers_;
+    bool stateful_ = false;  // has flags that depend on the previous messages (%u %i %o %O)
 
     std::tm get_time_(const details::log_msg &msg);
     template <typename Padder>
@@ -110,6 +112,15 @@ private:
                                                  std::string::const_iterator end);
 
     void compile_pattern_(const std::string &pattern);
+
+    // what a compiled formatter depends on
+    enum class flag_kind { other, literal, datetime };
+    static flag_kind kind_of_flag_(char flag);
+    // elapsed time flags, they keep the time of the previous message
+    static bool is_stateful_flag_(char flag);
+
+    // merge runs of datetime flags and literals into datetime_cache_formatters
+    void cache_datetime_runs_(const std::vector<flag_kind> &kinds);
 };
 }  // namespace spdlog
 
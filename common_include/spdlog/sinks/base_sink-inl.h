@@ -15,12 +15,14 @@
 
 template <typename Mutex>
 SPDLOG_INLINE spdlog::sinks::base_sink<Mutex>::base_sink()
-    : formatter_{details::make_unique<spdlog::pattern_formatter>()} {}
+    : formatter_{details::make_unique<spdlog::pattern_formatter>()},
+      format_id_{details::format_id(formatter_->output_key())} {}
 
 template <typename Mutex>
 SPDLOG_INLINE spdlog::sinks::base_sink<Mutex>::base_sink(
     std::unique_ptr<spdlog::formatter> formatter)
-    : formatter_{std::move(formatter)} {}
+    : formatter_{std::move(formatter)},
+      format_id_{formatter_ ? details::format_id(formatter_->output_key()) : 0} {}
 
 template <typename Mutex>
 void SPDLOG_INLINE spdlog::sinks::base_sink<Mutex>::log(const details::log_msg &msg) {
@@ -28,12 +30,72 @@ void SPDLOG_INLINE spdlog::sinks::base_sink<Mutex>::log(const details::log_msg &
     sink_it_(msg);
 }
 
+template <typename Mutex>
+void SPDLOG_INLINE spdlog::sinks::base_sink<Mutex>::log_batch(const details::log_msg *const *msgs,
+                                                              size_t count) {
+    std::lock_guard<Mutex> lock(mutex_);
+    sink_batch_(msgs, count);
+}
+
+template <typename Mutex>
+void SPDLOG_INLINE spdlog::sinks::base_sink<Mutex>::log_formatted(
+    const details::log_msg &msg, details::shared_format &shared) {
+    std::lock_guard<Mutex> lock(mutex_);
+    if (format_id_ == 0 || !accepts_formatted_()) {
+        sink_it_(msg);
+        return;
+    }
+    if (shared.format_id != format_id_) {
+        if (shared.format_id != 0) {
+            // the sinks before this one use another format
+            sink_it_(msg);
+            return;
+        }
+        shared.formatted.clear();
+        formatter_->format(msg, shared.formatted);
+        shared.format_id = format_id_;
+    }
+    sink_formatted_(msg, shared.formatted);
+}
+
+template <typename Mutex>
+void SPDLOG_INLINE spdlog::sinks::base_sink<Mutex>::log_batch_formatted(
+    const details::log_msg *const *msgs, size_t count, details::shared_batch_format &shared) {
+    std::lock_guard<Mutex> lock(mutex_);
+    if (format_id_ == 0 || !accepts_formatted_()) {
+        sink_batch_(msgs, count);
+        return;
+    }
+    if (shared.format_id != format_id_ || !shared.holds(msgs, count)) {
+        if (shared.format_id != 0) {
+            // the sinks before this one use another format, or log other messages of the run
+            sink_batch_(msgs, count);
+            return;
+        }
+        shared.msgs.assign(msgs, msgs + count);
+        shared.formatted.clear();
+        shared.ends.clear();
+        for (size_t i = 0; i < count; i++) {
+            formatter_->format(*msgs[i], shared.formatted);
+            shared.ends.push_back(shared.formatted.size());
+        }
+        shared.format_id = format_id_;
+    }
+    sink_batch_formatted_(msgs, count, shared.formatted, shared.ends.data());
+}
+
 template <typename Mutex>
 void SPDLOG_INLINE spdlog::sinks::base_sink<Mutex>::flush() {
     std::lock_guard<Mutex> lock(mutex_);
     flush_();
 }
 
+template <typename Mutex>
+void SPDLOG_INLINE spdlog::sinks::base_sink<Mutex>::request_flush() {
+    std::lock_guard<Mutex> lock(mutex_);
+    request_flush_();
+}
+
 template <typename Mutex>
 void SPDLOG_INLINE spdlog::sinks::base_sink<Mutex>::set_pattern(const std::string &pattern) {
     std::lock_guard<Mutex> lock(mutex_);
@@ -47,6 +109,46 @@ spdlog::sinks::base_sink<Mutex>::set_formatter(std::unique_ptr<spdlog::formatter
     set_formatter_(std::move(sink_formatter));
 }
 
+template <typename Mutex>
+void SPDLOG_INLINE spdlog::sinks::base_sink<Mutex>::sink_batch_(const details::log_msg *const *msgs,
+                                                                size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        sink_it_(*msgs[i]);
+    }
+}
+
+template <typename Mutex>
+void SPDLOG_INLINE spdlog::sinks::base_sink<Mutex>::request_flush_() {
+    flush_();
+}
+
+template <typename Mutex>
+void SPDLOG_INLINE spdlog::sinks::base_sink<Mutex>::sink_formatted_(const details::log_msg &msg,
+                                                                    const memory_buf_t &) {
+    sink_it_(msg);
+}
+
+template <typename Mutex>
+void SPDLOG_INLINE spdlog::sinks::base_sink<Mutex>::sink_batch_formatted_(
+    const details::log_msg *const *msgs,
+    size_t count,
+    const memory_buf_t &formatted,
+    const size_t *ends) {
+    memory_buf_t one;
+    size_t begin = 0;
+    for (size_t i = 0; i < count; i++) {
+        one.clear();
+        one.append(formatted.data() + begin, formatted.data() + ends[i]);
+        sink_formatted_(*msgs[i], one);
+        begin = ends[i];
+    }
+}
+
+template <typename Mutex>
+bool SPDLOG_INLINE spdlog::sinks::base_sink<Mutex>::accepts_formatted_() const {
+    return false;
+}
+
 template <typename Mutex>
 void SPDLOG_INLINE spdlog::sinks::base_sink<Mutex>::set_pattern_(const std::string &pattern) {
     set_formatter_(details::make_unique<spdlog::pattern_formatter>(pattern));
@@ -56,4 +158,5 @@ template <typename Mutex>
 void SPDLOG_INLINE
 spdlog::sinks::base_sink<Mutex>::set_formatter_(std::unique_ptr<spdlog::formatter> sink_formatter) {
     formatter_ = std::move(sink_formatter);
+    format_id_ = formatter_ ? details::format_id(formatter_->output_key()) : 0;
 }
@@ -5,6 +5,10 @@
 //
 // base sink templated over a mutex (either dummy or real)
 // concrete implementation should override the sink_it_() and flush_()  methods.
+// sinks that can write several messages at once may also override sink_batch_().
+// sinks that write the formatted message as is may override sink_formatted_() and
+// accepts_formatted_(), so the message is formatted once for all the sinks of a logger that
+// share the same format.
 // locking is taken care of in this class - no locking needed by the
 // implementers..
 //
@@ -29,7 +33,14 @@ public:
     base_sink &operator=(base_sink &&) = delete;
 
     void log(const details::log_msg &msg) final override;
+    void log_batch(const details::log_msg *const *msgs, size_t count) final override;
+    void log_formatted(const details::log_msg &msg,
+                       details::shared_format &shared) final override;
+    void log_batch_formatted(const details::log_msg *const *msgs,
+                             size_t count,
+                             details::shared_batch_format &shared) final override;
     void flush() final override;
+    void request_flush() final override;
     void set_pattern(const std::string &pattern) final override;
     void set_formatter(std::unique_ptr<spdlog::formatter> sink_formatter) final override;
 
@@ -37,9 +48,24 @@ protected:
     // sink formatter
     std::unique_ptr<spdlog::formatter> formatter_;
     Mutex mutex_;
+    // format_id() of the formatter's output key
+    size_t format_id_{0};
 
     virtual void sink_it_(const details::log_msg &msg) = 0;
     virtual void flush_() = 0;
+    // called with the mutex held. the default implementation calls flush_().
+    virtual void request_flush_();
+    // called with the mutex held. the default implementation calls sink_it_() for each message.
+    virtual void sink_batch_(const details::log_msg *const *msgs, size_t count);
+    // write the output of formatter_ for msg. only called if accepts_formatted_() returns true.
+    virtual void sink_formatted_(const details::log_msg &msg, const memory_buf_t &formatted);
+    // same for a run of messages, with their outputs back to back in formatted (ends[i] is the
+    // end of the output of msgs[i]). the default implementation calls sink_formatted_() for each.
+    virtual void sink_batch_formatted_(const details::log_msg *const *msgs,
+                                       size_t count,
+                                       const memory_buf_t &formatted,
+                                       const size_t *ends);
+    virtual bool accepts_formatted_() const;
     virtual void set_pattern_(const std::string &pattern);
     virtual void set_formatter_(std::unique_ptr<spdlog::formatter> sink_formatter);
 };
@@ -16,8 +16,8 @@ namespace sinks {
 template <typename Mutex>
 SPDLOG_INLINE basic_file_sink<Mutex>::basic_file_sink(const filename_t &filename,
                                                       bool truncate,
-                                                      const file_event_handlers &event_handlers)
-    : file_helper_{event_handlers} {
+                                                      const file_options &options)
+    : file_helper_{options} {
     file_helper_.open(filename, truncate);
 }
 
@@ -36,6 +36,31 @@ template <typename Mutex>
 SPDLOG_INLINE void basic_file_sink<Mutex>::sink_it_(const details::log_msg &msg) {
     memory_buf_t formatted;
     base_sink<Mutex>::formatter_->format(msg, formatted);
+    sink_formatted_(msg, formatted);
+}
+
+template <typename Mutex>
+SPDLOG_INLINE void basic_file_sink<Mutex>::sink_formatted_(const details::log_msg &,
+                                                           const memory_buf_t &formatted) {
+    file_helper_.write(formatted);
+}
+
+// format the whole batch into one buffer and write it at once
+template <typename Mutex>
+SPDLOG_INLINE void basic_file_sink<Mutex>::sink_batch_(const details::log_msg *const *msgs,
+                                                       size_t count) {
+    memory_buf_t formatted;
+    for (size_t i = 0; i < count; i++) {
+        base_sink<Mutex>::formatter_->format(*msgs[i], formatted);
+    }
+    file_helper_.write(formatted);
+}
+
+template <typename Mutex>
+SPDLOG_INLINE void basic_file_sink<Mutex>::sink_batch_formatted_(const details::log_msg *const *,
+                                                                 size_t,
+                                                                 const memory_buf_t &formatted,
+                                                                 const size_t *) {
     file_helper_.write(formatted);
 }
 
@@ -44,5 +69,10 @@ SPDLOG_INLINE void basic_file_sink<Mutex>::flush_() {
     file_helper_.flush();
 }
 
+template <typename Mutex>
+SPDLOG_INLINE void basic_file_sink<Mutex>::request_flush_() {
+    file_helper_.request_flush();
+}
+
 }  // namespace sinks
 }  // namespace spdlog
@@ -21,13 +21,21 @@ class basic_file_sink final : public base_sink<Mutex> {
 public:
     explicit basic_file_sink(const filename_t &filename,
                              bool truncate = false,
-                             const file_event_handlers &event_handlers = {});
+                             const file_options &options = {});
     const filename_t &filename() const;
     void truncate();
 
 protected:
     void sink_it_(const details::log_msg &msg) override;
+    void sink_formatted_(const details::log_msg &msg, const memory_buf_t &formatted) override;
+    bool accepts_formatted_() const override { return true; }
+    void sink_batch_(const details::log_msg *const *msgs, size_t count) override;
+    void sink_batch_formatted_(const details::log_msg *const *msgs,
+                               size_t count,
+                               const memory_buf_t &formatted,
+                               const size_t *ends) override;
     void flush_() override;
+    void request_flush_() override;
 
 private:
     details::file_helper file_helper_;
@@ -45,18 +53,18 @@ template <typename Factory = spdlog::synchronous_factory>
 inline std::shared_ptr<logger> basic_logger_mt(const std::string &logger_name,
                                                const filename_t &filename,
                                                bool truncate = false,
-                                               const file_event_handlers &event_handlers = {}) {
+                                               const file_options &options = {}) {
     return Factory::template create<sinks::basic_file_sink_mt>(logger_name, filename, truncate,
-                                                               event_handlers);
+                                                               options);
 }
 
 template <typename Factory = spdlog::synchronous_factory>
 inline std::shared_ptr<logger> basic_logger_st(const std::string &logger_name,
                                                const filename_t &filename,
                                                bool truncate = false,
-                                               const file_event_handlers &event_handlers = {}) {
+                                               const file_options &options = {}) {
     return Factory::template create<sinks::basic_file_sink_st>(logger_name, filename, truncate,
-                                                               event_handlers);
+                                                               options);
 }
 
 }  // namespace spdlog
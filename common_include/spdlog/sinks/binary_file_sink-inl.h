@@ -0,0 +1,82 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#ifndef SPDLOG_HEADER_ONLY
+    #include <spdlog/sinks/binary_file_sink.h>
+#endif
+
+#include <spdlog/common.h>
+
+namespace spdlog {
+namespace sinks {
+
+template <typename Mutex>
+SPDLOG_INLINE binary_file_sink<Mutex>::binary_file_sink(const filename_t &filename,
+                                                        bool truncate,
+                                                        const file_options &options)
+    : file_helper_{options} {
+    file_helper_.open(filename, truncate);
+    encoder_.begin(file_helper_.size() == 0, buffer_);
+    write_buffer_();
+}
+
+template <typename Mutex>
+SPDLOG_INLINE const filename_t &binary_file_sink<Mutex>::filename() const {
+    return file_helper_.filename();
+}
+
+template <typename Mutex>
+SPDLOG_INLINE void binary_file_sink<Mutex>::truncate() {
+    std::lock_guard<Mutex> lock(base_sink<Mutex>::mutex_);
+    file_helper_.reopen(true);
+    buffer_.clear();
+    encoder_.begin(true, buffer_);
+    write_buffer_();
+}
+
+template <typename Mutex>
+SPDLOG_INLINE void binary_file_sink<Mutex>::sink_it_(const details::log_msg &msg) {
+    encoder_.rollback();  // in case the last write failed
+    buffer_.clear();
+    encoder_.encode(msg, buffer_);
+    write_buffer_();
+}
+
+template <typename Mutex>
+SPDLOG_INLINE void binary_file_sink<Mutex>::sink_batch_(const details::log_msg *const *msgs,
+                                                        size_t count) {
+    encoder_.rollback();
+    buffer_.clear();
+    for (size_t i = 0; i < count; i++) {
+        encoder_.encode(*msgs[i], buffer_);
+    }
+    write_buffer_();
+}
+
+template <typename Mutex>
+SPDLOG_INLINE bool binary_file_sink<Mutex>::needs_payload() {
+    return false;
+}
+
+// the new dictionary entries count only once they are in the file
+template <typename Mutex>
+SPDLOG_INLINE void binary_file_sink<Mutex>::write_buffer_() {
+    file_helper_.write(buffer_);
+    encoder_.commit();
+    buffer_.clear();
+}
+
+template <typename Mutex>
+SPDLOG_INLINE void binary_file_sink<Mutex>::flush_() {
+    file_helper_.flush();
+}
+
+template <typename Mutex>
+SPDLOG_INLINE void binary_file_sink<Mutex>::request_flush_() {
+    file_helper_.request_flush();
+}
+
+}  // namespace sinks
+}  // namespace spdlog
@@ -0,0 +1,80 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#include <spdlog/details/binary_log.h>
+#include <spdlog/details/file_helper.h>
+#include <spdlog/details/null_mutex.h>
+#include <spdlog/details/synchronous_factory.h>
+#include <spdlog/sinks/base_sink.h>
+
+#include <mutex>
+#include <string>
+
+namespace spdlog {
+namespace sinks {
+/*
+ * File sink writing the compact binary format of details/binary_log.h instead of text.
+ * Format strings and names are written once, and messages of loggers in deferred format mode
+ * (async_logger::set_deferred_format) are stored as their captured arguments instead of the
+ * formatted text. The arguments are formatted on the thread pool only if other sinks of the
+ * logger need the text (see sink::needs_payload). Use the binlog_decoder tool to turn the file
+ * back into text. The formatter of the sink is not used.
+ */
+template <typename Mutex>
+class binary_file_sink final : public base_sink<Mutex> {
+public:
+    explicit binary_file_sink(const filename_t &filename,
+                              bool truncate = false,
+                              const file_options &options = {});
+    const filename_t &filename() const;
+    void truncate();
+    // deferred messages are written as their captured arguments
+    bool needs_payload() override;
+
+protected:
+    void sink_it_(const details::log_msg &msg) override;
+    void sink_batch_(const details::log_msg *const *msgs, size_t count) override;
+    void flush_() override;
+    void request_flush_() override;
+
+private:
+    void write_buffer_();
+
+    details::file_helper file_helper_;
+    details::binary_log_encoder encoder_;
+    memory_buf_t buffer_;
+};
+
+using binary_file_sink_mt = binary_file_sink<std::mutex>;
+using binary_file_sink_st = binary_file_sink<details::null_mutex>;
+
+}  // namespace sinks
+
+//
+// factory functions
+//
+template <typename Factory = spdlog::synchronous_factory>
+inline std::shared_ptr<logger> binary_logger_mt(const std::string &logger_name,
+                                                const filename_t &filename,
+                                                bool truncate = false,
+                                                const file_options &options = {}) {
+    return Factory::template create<sinks::binary_file_sink_mt>(logger_name, filename, truncate,
+                                                                options);
+}
+
+template <typename Factory = spdlog::synchronous_factory>
+inline std::shared_ptr<logger> binary_logger_st(const std::string &logger_name,
+                                                const filename_t &filename,
+                                                bool truncate = false,
+                                                const file_options &options = {}) {
+    return Factory::template create<sinks::binary_file_sink_st>(logger_name, filename, truncate,
+                                                                options);
+}
+
+}  // namespace spdlog
+
+#ifdef SPDLOG_HEADER_ONLY
+    #include "binary_file_sink-inl.h"
+#endif
@@ -74,11 +74,11 @@ public:
                     int rotation_minute,
                     bool truncate = false,
                     uint16_t max_files = 0,
-                    const file_event_handlers &event_handlers = {})
+                    const file_options &options = {})
         : base_filename_(std::move(base_filename)),
           rotation_h_(rotation_hour),
           rotation_m_(rotation_minute),
-          file_helper_{event_handlers},
+          file_helper_{options},
           truncate_(truncate),
           max_files_(max_files),
           filenames_q_() {
@@ -104,6 +104,12 @@ public:
 
 protected:
     void sink_it_(const details::log_msg &msg) override {
+        memory_buf_t formatted;
+        base_sink<Mutex>::formatter_->format(msg, formatted);
+        sink_formatted_(msg, formatted);
+    }
+
+    void sink_formatted_(const details::log_msg &msg, const memory_buf_t &formatted) override {
         auto time = msg.time;
         bool should_rotate = time >= rotation_tp_;
         if (should_rotate) {
@@ -111,8 +117,6 @@ protected:
             file_helper_.open(filename, truncate_);
             rotation_tp_ = next_rotation_tp_();
         }
-        memory_buf_t formatted;
-        base_sink<Mutex>::formatter_->format(msg, formatted);
         file_helper_.write(formatted);
 
         // Do the cleaning only at the end because it might throw on failure.
@@ -121,8 +125,12 @@ protected:
         }
     }
 
+    bool accepts_formatted_() const override { return true; }
+
     void flush_() override { file_helper_.flush(); }
 
+    void request_flush_() override { file_helper_.request_flush(); }
+
 private:
     void init_filenames_q_() {
         using details::os::path_exists;
@@ -209,9 +217,9 @@ inline std::shared_ptr<logger> daily_logger_mt(const std::string &logger_name,
                                                int minute = 0,
                                                bool truncate = false,
                                                uint16_t max_files = 0,
-                                               const file_event_handlers &event_handlers = {}) {
+                                               const file_options &options = {}) {
     return Factory::template create<sinks::daily_file_sink_mt>(logger_name, filename, hour, minute,
-                                                               truncate, max_files, event_handlers);
+                                                               truncate, max_files, options);
 }
 
 template <typename Factory = spdlog::synchronous_factory>
@@ -222,9 +230,9 @@ inline std::shared_ptr<logger> daily_logger_format_mt(
     int minute = 0,
     bool truncate = false,
     uint16_t max_files = 0,
-    const file_event_handlers &event_handlers = {}) {
+    const file_options &options = {}) {
     return Factory::template create<sinks::daily_file_format_sink_mt>(
-        logger_name, filename, hour, minute, truncate, max_files, event_handlers);
+        logger_name, filename, hour, minute, truncate, max_files, options);
 }
 
 template <typename Factory = spdlog::synchronous_factory>
@@ -234,9 +242,9 @@ inline std::shared_ptr<logger> daily_logger_st(const std::string &logger_name,
                                                int minute = 0,
                                                bool truncate = false,
                                                uint16_t max_files = 0,
-                                               const file_event_handlers &event_handlers = {}) {
+                                               const file_options &options = {}) {
     return Factory::template create<sinks::daily_file_sink_st>(logger_name, filename, hour, minute,
-                                                               truncate, max_files, event_handlers);
+                                                               truncate, max_files, options);
 }
 
 template <typename Factory = spdlog::synchronous_factory>
@@ -247,8 +255,8 @@ inline std::shared_ptr<logger> daily_logger_format_st(
     int minute = 0,
     bool truncate = false,
     uint16_t max_files = 0,
-    const file_event_handlers &event_handlers = {}) {
+    const file_options &options = {}) {
     return Factory::template create<sinks::daily_file_format_sink_st>(
-        logger_name, filename, hour, minute, truncate, max_files, event_handlers);
+        logger_name, filename, hour, minute, truncate, max_files, options);
 }
 }  // namespace spdlog
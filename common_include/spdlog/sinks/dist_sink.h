@@ -46,6 +46,16 @@ public:
 
     std::vector<std::shared_ptr<sink>> &sinks() { return sinks_; }
 
+    bool needs_payload() override {
+        std::lock_guard<Mutex> lock(base_sink<Mutex>::mutex_);
+        for (auto &sub_sink : sinks_) {
+            if (sub_sink->needs_payload()) {
+                return true;
+            }
+        }
+        return false;
+    }
+
 protected:
     void sink_it_(const details::log_msg &msg) override {
         for (auto &sub_sink : sinks_) {
@@ -61,6 +71,12 @@ protected:
         }
     }
 
+    void request_flush_() override {
+        for (auto &sub_sink : sinks_) {
+            sub_sink->request_flush();
+        }
+    }
+
     void set_pattern_(const std::string &pattern) override {
         set_formatter_(details::make_unique<spdlog::pattern_formatter>(pattern));
     }
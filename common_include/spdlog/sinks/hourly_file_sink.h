@@ -49,9 +49,9 @@ public:
     hourly_file_sink(filename_t base_filename,
                      bool truncate = false,
                      uint16_t max_files = 0,
-                     const file_event_handlers &event_handlers = {})
+                     const file_options &options = {})
         : base_filename_(std::move(base_filename)),
-          file_helper_{event_handlers},
+          file_helper_{options},
           truncate_(truncate),
           max_files_(max_files),
           filenames_q_() {
@@ -73,6 +73,12 @@ public:
 
 protected:
     void sink_it_(const details::log_msg &msg) override {
+        memory_buf_t formatted;
+        base_sink<Mutex>::formatter_->format(msg, formatted);
+        sink_formatted_(msg, formatted);
+    }
+
+    void sink_formatted_(const details::log_msg &msg, const memory_buf_t &formatted) override {
         auto time = msg.time;
         bool should_rotate = time >= rotation_tp_;
         if (should_rotate) {
@@ -85,8 +91,6 @@ protected:
             rotation_tp_ = next_rotation_tp_();
         }
         remove_init_file_ = false;
-        memory_buf_t formatted;
-        base_sink<Mutex>::formatter_->format(msg, formatted);
         file_helper_.write(formatted);
 
         // Do the cleaning only at the end because it might throw on failure.
@@ -95,8 +99,12 @@ protected:
         }
     }
 
+    bool accepts_formatted_() const override { return true; }
+
     void flush_() override { file_helper_.flush(); }
 
+    void request_flush_() override { file_helper_.request_flush(); }
+
 private:
     void init_filenames_q_() {
         using details::os::path_exists;
@@ -176,9 +184,9 @@ inline std::shared_ptr<logger> hourly_logger_mt(const std::string &logger_name,
                                                 const filename_t &filename,
                                                 bool truncate = false,
                                                 uint16_t max_files = 0,
-                                                const file_event_handlers &event_handlers = {}) {
+                                                const file_options &options = {}) {
     return Factory::template create<sinks::hourly_file_sink_mt>(logger_name, filename, truncate,
-                                                                max_files, event_handlers);
+                                                                max_files, options);
 }
 
 template <typename Factory = spdlog::synchronous_factory>
@@ -186,8 +194,8 @@ inline std::shared_ptr<logger> hourly_logger_st(const std::string &logger_name,
                                                 const filename_t &filename,
                                                 bool truncate = false,
                                                 uint16_t max_files = 0,
-                                                const file_event_handlers &event_handlers = {}) {
+                                                const file_options &options = {}) {
     return Factory::template create<sinks::hourly_file_sink_st>(logger_name, filename, truncate,
-                                                                max_files, event_handlers);
+                                                                max_files, options);
 }
 }  // namespace spdlog
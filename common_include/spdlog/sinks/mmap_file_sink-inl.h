@@ -0,0 +1,65 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#ifndef SPDLOG_HEADER_ONLY
+    #include <spdlog/sinks/mmap_file_sink.h>
+#endif
+
+#include <spdlog/common.h>
+
+namespace spdlog {
+namespace sinks {
+
+template <typename Mutex>
+SPDLOG_INLINE mmap_file_sink<Mutex>::mmap_file_sink(const filename_t &filename,
+                                                    bool truncate,
+                                                    const mmap_file_options &options)
+    : file_{options} {
+    file_.open(filename, truncate);
+}
+
+template <typename Mutex>
+SPDLOG_INLINE const filename_t &mmap_file_sink<Mutex>::filename() const {
+    return file_.filename();
+}
+
+template <typename Mutex>
+SPDLOG_INLINE void mmap_file_sink<Mutex>::sink_it_(const details::log_msg &msg) {
+    memory_buf_t formatted;
+    base_sink<Mutex>::formatter_->format(msg, formatted);
+    file_.write(formatted.data(), formatted.size());
+}
+
+template <typename Mutex>
+SPDLOG_INLINE void mmap_file_sink<Mutex>::sink_formatted_(const details::log_msg &,
+                                                          const memory_buf_t &formatted) {
+    file_.write(formatted.data(), formatted.size());
+}
+
+template <typename Mutex>
+SPDLOG_INLINE void mmap_file_sink<Mutex>::sink_batch_(const details::log_msg *const *msgs,
+                                                      size_t count) {
+    memory_buf_t formatted;
+    for (size_t i = 0; i < count; i++) {
+        base_sink<Mutex>::formatter_->format(*msgs[i], formatted);
+    }
+    file_.write(formatted.data(), formatted.size());
+}
+
+template <typename Mutex>
+SPDLOG_INLINE void mmap_file_sink<Mutex>::sink_batch_formatted_(const details::log_msg *const *,
+                                                                size_t,
+                                                                const memory_buf_t &formatted,
+                                                                const size_t *) {
+    file_.write(formatted.data(), formatted.size());
+}
+
+template <typename Mutex>
+SPDLOG_INLINE void mmap_file_sink<Mutex>::flush_() {
+    file_.flush();
+}
+
+}  // namespace sinks
+}  // namespace spdlog
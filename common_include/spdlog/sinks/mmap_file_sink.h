@@ -0,0 +1,73 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#include <spdlog/details/mmap_file.h>
+#include <spdlog/details/null_mutex.h>
+#include <spdlog/details/synchronous_factory.h>
+#include <spdlog/sinks/base_sink.h>
+
+#include <mutex>
+#include <string>
+
+namespace spdlog {
+namespace sinks {
+/*
+ * Append-only file sink writing through a memory mapping (POSIX only).
+ * Logging a message copies it into the mapping, without system calls (see details/mmap_file.h).
+ */
+template <typename Mutex>
+class mmap_file_sink final : public base_sink<Mutex> {
+public:
+    explicit mmap_file_sink(const filename_t &filename,
+                            bool truncate = false,
+                            const mmap_file_options &options = {});
+    const filename_t &filename() const;
+
+protected:
+    void sink_it_(const details::log_msg &msg) override;
+    void sink_formatted_(const details::log_msg &msg, const memory_buf_t &formatted) override;
+    bool accepts_formatted_() const override { return true; }
+    void sink_batch_(const details::log_msg *const *msgs, size_t count) override;
+    void sink_batch_formatted_(const details::log_msg *const *msgs,
+                               size_t count,
+                               const memory_buf_t &formatted,
+                               const size_t *ends) override;
+    void flush_() override;
+
+private:
+    details::mmap_file file_;
+};
+
+using mmap_file_sink_mt = mmap_file_sink<std::mutex>;
+using mmap_file_sink_st = mmap_file_sink<details::null_mutex>;
+
+}  // namespace sinks
+
+//
+// factory functions
+//
+template <typename Factory = spdlog::synchronous_factory>
+inline std::shared_ptr<logger> mmap_logger_mt(const std::string &logger_name,
+                                              const filename_t &filename,
+                                              bool truncate = false,
+                                              const mmap_file_options &options = {}) {
+    return Factory::template create<sinks::mmap_file_sink_mt>(logger_name, filename, truncate,
+                                                              options);
+}
+
+template <typename Factory = spdlog::synchronous_factory>
+inline std::shared_ptr<logger> mmap_logger_st(const std::string &logger_name,
+                                              const filename_t &filename,
+                                              bool truncate = false,
+                                              const mmap_file_options &options = {}) {
+    return Factory::template create<sinks::mmap_file_sink_st>(logger_name, filename, truncate,
+                                                              options);
+}
+
+}  // namespace spdlog
+
+#ifdef SPDLOG_HEADER_ONLY
+    #include "mmap_file_sink-inl.h"
+#endif
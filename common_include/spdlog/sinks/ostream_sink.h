@@ -24,12 +24,18 @@ protected:
     void sink_it_(const details::log_msg &msg) override {
         memory_buf_t formatted;
         base_sink<Mutex>::formatter_->format(msg, formatted);
+        sink_formatted_(msg, formatted);
+    }
+
+    void sink_formatted_(const details::log_msg &, const memory_buf_t &formatted) override {
         ostream_.write(formatted.data(), static_cast<std::streamsize>(formatted.size()));
         if (force_flush_) {
             ostream_.flush();
         }
     }
 
+    bool accepts_formatted_() const override { return true; }
+
     void flush_() override { ostream_.flush(); }
 
     std::ostream &ostream_;
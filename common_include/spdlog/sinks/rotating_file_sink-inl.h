@@ -18,6 +18,7 @@
 #include <mutex>
 #include <string>
 #include <tuple>
+#include <utility>
 
 namespace spdlog {
 namespace sinks {
@@ -28,11 +29,12 @@ SPDLOG_INLINE rotating_file_sink<Mutex>::rotating_file_sink(
     std::size_t max_size,
     std::size_t max_files,
     bool rotate_on_open,
-    const file_event_handlers &event_handlers)
+    const file_options &options)
     : base_filename_(std::move(base_filename)),
       max_size_(max_size),
       max_files_(max_files),
-      file_helper_{event_handlers} {
+      options_(options),
+      file_helper_(new details::file_helper(options)) {
     if (max_size == 0) {
         throw_spdlog_ex("rotating sink constructor: max_size arg cannot be zero");
     }
@@ -40,12 +42,36 @@ SPDLOG_INLINE rotating_file_sink<Mutex>::rotating_file_sink(
     if (max_files > MaxFiles) {
         throw_spdlog_ex("rotating sink constructor: max_files arg cannot exceed MaxFiles");
     }
-    file_helper_.open(calc_filename(base_filename_, 0));
-    current_size_ = file_helper_.size();  // expensive. called only once
+    file_helper_->open(calc_filename(base_filename_, 0));
+    current_size_ = file_helper_->size();  // expensive. called only once
     if (rotate_on_open && current_size_ > 0) {
         rotate_();
         current_size_ = 0;
     }
+
+#ifndef _WIN32
+    // (windows can't rename the open next file)
+    if (options.background_rotation) {
+        next_filename_ = calc_next_filename_(0);
+        background_ = true;
+        housekeeper_ = std::thread([this] { housekeeping_loop_(); });
+    }
+#endif
+}
+
+template <typename Mutex>
+SPDLOG_INLINE rotating_file_sink<Mutex>::~rotating_file_sink() {
+    if (!background_) {
+        return;
+    }
+    // the housekeeping thread finishes the pending renames before exiting
+    {
+        std::lock_guard<std::mutex> lock(hk_mutex_);
+        hk_stop_ = true;
+    }
+    hk_cv_.notify_all();
+    housekeeper_.join();
+    apply_rename_();
 }
 
 // calc filename according to index and file extension if exists.
@@ -66,7 +92,11 @@ SPDLOG_INLINE filename_t rotating_file_sink<Mutex>::calc_filename(const filename
 template <typename Mutex>
 SPDLOG_INLINE filename_t rotating_file_sink<Mutex>::filename() {
     std::lock_guard<Mutex> lock(base_sink<Mutex>::mutex_);
-    return file_helper_.filename();
+    if (background_) {
+        std::lock_guard<std::mutex> hk_lock(hk_mutex_);
+        apply_rename_();
+    }
+    return file_helper_->filename();
 }
 
 template <typename Mutex>
@@ -108,25 +138,99 @@ template <typename Mutex>
 SPDLOG_INLINE void rotating_file_sink<Mutex>::sink_it_(const details::log_msg &msg) {
     memory_buf_t formatted;
     base_sink<Mutex>::formatter_->format(msg, formatted);
+    sink_formatted_(msg, formatted);
+}
+
+template <typename Mutex>
+SPDLOG_INLINE void rotating_file_sink<Mutex>::sink_formatted_(const details::log_msg &,
+                                                              const memory_buf_t &formatted) {
     auto new_size = current_size_ + formatted.size();
 
     // rotate if the new estimated file size exceeds max size.
     // rotate only if the real size > 0 to better deal with full disk (see issue #2261).
     // we only check the real size when new_size > max_size_ because it is relatively expensive.
     if (new_size > max_size_) {
-        file_helper_.flush();
-        if (file_helper_.size() > 0) {
+        file_helper_->flush();
+        if (file_helper_->size() > 0) {
             rotate_();
             new_size = formatted.size();
         }
     }
-    file_helper_.write(formatted);
+    file_helper_->write(formatted);
     current_size_ = new_size;
+    prepare_next_();
+}
+
+// same as sink_it_(), but collect the messages that go to the same file and write them at once.
+template <typename Mutex>
+SPDLOG_INLINE void rotating_file_sink<Mutex>::sink_batch_(const details::log_msg *const *msgs,
+                                                          size_t count) {
+    memory_buf_t pending;
+    memory_buf_t formatted;
+    for (size_t i = 0; i < count; i++) {
+        formatted.clear();
+        base_sink<Mutex>::formatter_->format(*msgs[i], formatted);
+        auto new_size = current_size_ + formatted.size();
+
+        if (new_size > max_size_) {
+            file_helper_->write(pending);
+            pending.clear();
+            file_helper_->flush();
+            if (file_helper_->size() > 0) {
+                rotate_();
+                new_size = formatted.size();
+            }
+        }
+        pending.append(formatted.data(), formatted.data() + formatted.size());
+        current_size_ = new_size;
+    }
+    file_helper_->write(pending);
+    prepare_next_();
+}
+
+// same as sink_batch_() with the outputs formatted by another sink.
+template <typename Mutex>
+SPDLOG_INLINE void rotating_file_sink<Mutex>::sink_batch_formatted_(const details::log_msg *const *,
+                                                                    size_t count,
+                                                                    const memory_buf_t &formatted,
+                                                                    const size_t *ends) {
+    memory_buf_t pending;
+    size_t written = 0;  // start of the outputs not written yet
+    size_t begin = 0;
+    for (size_t i = 0; i < count; i++) {
+        auto size = ends[i] - begin;
+        auto new_size = current_size_ + size;
+        if (new_size > max_size_) {
+            pending.append(formatted.data() + written, formatted.data() + begin);
+            file_helper_->write(pending);
+            pending.clear();
+            written = begin;
+            file_helper_->flush();
+            if (file_helper_->size() > 0) {
+                rotate_();
+                new_size = size;
+            }
+        }
+        current_size_ = new_size;
+        begin = ends[i];
+    }
+    if (written == 0) {
+        file_helper_->write(formatted);
+    } else {
+        pending.append(formatted.data() + written, formatted.data() + begin);
+        file_helper_->write(pending);
+    }
+    prepare_next_();
 }
 
 template <typename Mutex>
 SPDLOG_INLINE void rotating_file_sink<Mutex>::flush_() {
-    file_helper_.flush();
+    file_helper_->flush();
+}
+
+template <typename Mutex>
+SPDLOG_INLINE void rotating_file_sink<Mutex>::request_flush_() {
+    file_helper_->request_flush();
 }
 
 // Rotate files:
@@ -136,11 +240,34 @@ SPDLOG_INLINE void rotating_file_sink<Mutex>::flush_() {
 // log.3.txt -> delete
 template <typename Mutex>
 SPDLOG_INLINE void rotating_file_sink<Mutex>::rotate_() {
+    if (background_ && rotate_in_background_()) {
+        return;
+    }
+    rotate_sync_();
+}
+
+template <typename Mutex>
+SPDLOG_INLINE void rotating_file_sink<Mutex>::rotate_sync_() {
+    file_helper_->close();
+    std::string error;
+    int error_no = 0;
+    bool renamed = rename_files_(max_files_, error, error_no);
+    // truncate the log file anyway if the renames failed, to prevent it to grow beyond its limit!
+    file_helper_->open(base_filename_, true);
+    if (!renamed) {
+        current_size_ = 0;
+        throw_spdlog_ex(error, error_no);
+    }
+}
+
+template <typename Mutex>
+SPDLOG_INLINE bool rotating_file_sink<Mutex>::rename_files_(std::size_t max_files,
+                                                            std::string &error,
+                                                            int &error_no) {
     using details::os::filename_to_str;
     using details::os::path_exists;
 
-    file_helper_.close();
-    for (auto i = max_files_; i > 0; --i) {
+    for (auto i = max_files; i > 0; --i) {
         filename_t src = calc_filename(base_filename_, i - 1);
         if (!path_exists(src)) {
             continue;
@@ -153,16 +280,156 @@ SPDLOG_INLINE void rotating_file_sink<Mutex>::rotate_() {
             // rates can cause the rename to fail with permission denied (because of antivirus?).
             details::os::sleep_for_millis(100);
             if (!rename_file_(src, target)) {
-                file_helper_.reopen(
-                    true);  // truncate the log file anyway to prevent it to grow beyond its limit!
-                current_size_ = 0;
-                throw_spdlog_ex("rotating_file_sink: failed renaming " + filename_to_str(src) +
-                                    " to " + filename_to_str(target),
-                                errno);
+                error_no = errno;
+                error = "rotating_file_sink: failed renaming " + filename_to_str(src) + " to " +
+                        filename_to_str(target);
+                return false;
             }
         }
     }
-    file_helper_.reopen(true);
+    return true;
+}
+
+// switch to the next file opened by the housekeeping thread, which then does the renames.
+// returns false if there is no next file to switch to.
+template <typename Mutex>
+SPDLOG_INLINE bool rotating_file_sink<Mutex>::rotate_in_background_() {
+    std::unique_lock<std::mutex> lock(hk_mutex_);
+    // normally nothing to wait for: the previous renames and the next file are long done
+    hk_cv_.wait(lock, [this] { return !hk_busy_ && !retired_ && !prepare_; });
+    apply_rename_();
+    next_requested_ = false;
+    std::string error;
+    std::swap(error, hk_error_);
+    auto error_no = hk_errno_;
+
+    // (the current file keeps the next file name if the previous renames failed)
+    bool ready = next_ && file_helper_->filename() == base_filename_;
+    if (ready) {
+        retired_ = std::move(file_helper_);
+        file_helper_ = std::move(next_);
+        retired_max_files_ = max_files_;
+    }
+    lock.unlock();
+    hk_cv_.notify_all();
+
+    if (!error.empty()) {
+        if (ready) {
+            current_size_ = 0;
+        }
+        throw_spdlog_ex(error, error_no);
+    }
+    return ready;
+}
+
+// ask the housekeeping thread for the next file once the current one is half full
+template <typename Mutex>
+SPDLOG_INLINE void rotating_file_sink<Mutex>::prepare_next_() {
+    if (!background_ || next_requested_ || current_size_ < max_size_ / 2) {
+        return;
+    }
+    next_requested_ = true;
+    {
+        std::lock_guard<std::mutex> lock(hk_mutex_);
+        prepare_ = true;
+    }
+    hk_cv_.notify_all();
+}
+
+// give file_helper_ the name the housekeeping thread gave to its file.
+// called with hk_mutex_ held, or once the housekeeping thread has stopped.
+template <typename Mutex>
+SPDLOG_INLINE void rotating_file_sink<Mutex>::apply_rename_() {
+    if (renamed_) {
+        file_helper_->renamed(base_filename_);
+        renamed_ = false;
+    }
+}
+
+template <typename Mutex>
+SPDLOG_INLINE void rotating_file_sink<Mutex>::housekeeping_loop_() {
+    std::unique_lock<std::mutex> lock(hk_mutex_);
+    for (;;) {
+        hk_cv_.wait(lock, [this] { return hk_stop_ || retired_ || prepare_; });
+
+        if (retired_) {
+            // close the previous file, shift the files and give the current file the base name
+            std::unique_ptr<details::file_helper> retired = std::move(retired_);
+            auto max_files = retired_max_files_;
+            hk_busy_ = true;
+            lock.unlock();
+
+            SPDLOG_TRY { retired->close(); }
+            SPDLOG_CATCH_STD
+            retired.reset();
+            std::string error;
+            int error_no = 0;
+            // (if the shifts failed, the previous file is dropped like rotate_sync_() does)
+            (void)rename_files_(max_files, error, error_no);
+            bool renamed = rename_file_(next_filename_, base_filename_);
+            if (!renamed && error.empty()) {
+                error_no = errno;
+                error = "rotating_file_sink: failed renaming " +
+                        details::os::filename_to_str(next_filename_) + " to " +
+                        details::os::filename_to_str(base_filename_);
+            }
+
+            lock.lock();
+            renamed_ = renamed;
+            if (!renamed) {
+                // the current file keeps the next file name until rotate_sync_()
+                next_filename_ = calc_next_filename_(++next_seq_);
+            }
+            if (!error.empty()) {
+                hk_error_ = std::move(error);
+                hk_errno_ = error_no;
+            }
+            hk_busy_ = false;
+            hk_cv_.notify_all();
+        } else if (hk_stop_) {
+            // remove the next file if it was not used
+            if (next_) {
+                next_.reset();
+                (void)details::os::remove(next_filename_);
+            }
+            return;
+        } else {
+            prepare_ = false;
+            if (next_) {
+                continue;
+            }
+            hk_busy_ = true;
+            lock.unlock();
+
+            std::unique_ptr<details::file_helper> next(new details::file_helper(options_));
+            bool opened = false;
+            SPDLOG_TRY {
+                next->open(next_filename_, true);
+                opened = true;
+            }
+            SPDLOG_CATCH_STD
+            if (!opened) {
+                next.reset();  // rotate_() falls back to rotate_sync_()
+            }
+
+            lock.lock();
+            next_ = std::move(next);
+            hk_busy_ = false;
+            hk_cv_.notify_all();
+        }
+    }
+}
+
+template <typename Mutex>
+SPDLOG_INLINE filename_t rotating_file_sink<Mutex>::calc_next_filename_(std::size_t seq) const {
+    filename_t basename;
+    filename_t ext;
+    std::tie(basename, ext) = details::file_helper::split_by_extension(base_filename_);
+    if (seq == 0) {
+        return basename + SPDLOG_FILENAME_T(".next") + ext;
+    }
+    return fmt_lib::format(SPDLOG_FMT_STRING(SPDLOG_FILENAME_T("{}.next{}{}")), basename, seq,
+                           ext);
 }
 
 // delete the target if exists, and rename the src file  to target
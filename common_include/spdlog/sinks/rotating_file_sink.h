@@ -8,8 +8,11 @@
 #include <spdlog/details/synchronous_factory.h>
 #include <spdlog/sinks/base_sink.h>
 
+#include <condition_variable>
+#include <memory>
 #include <mutex>
 #include <string>
+#include <thread>
 
 namespace spdlog {
 namespace sinks {
@@ -17,6 +20,11 @@ namespace sinks {
 //
 // Rotating file sink based on size
 //
+// With file_options::background_rotation, a housekeeping thread opens the next file
+// ("log.next.txt") once the current one is half full. The rotation switches to it, and the
+// housekeeping thread then closes the previous file, renames the files and gives the new file
+// its name. Errors of the background renames are thrown by the next rotation.
+//
 template <typename Mutex>
 class rotating_file_sink final : public base_sink<Mutex> {
 public:
@@ -25,7 +33,8 @@ public:
                        std::size_t max_size,
                        std::size_t max_files,
                        bool rotate_on_open = false,
-                       const file_event_handlers &event_handlers = {});
+                       const file_options &options = {});
+    ~rotating_file_sink() override;
     static filename_t calc_filename(const filename_t &filename, std::size_t index);
     filename_t filename();
     void rotate_now();
@@ -36,7 +45,15 @@ public:
 
 protected:
     void sink_it_(const details::log_msg &msg) override;
+    void sink_formatted_(const details::log_msg &msg, const memory_buf_t &formatted) override;
+    bool accepts_formatted_() const override { return true; }
+    void sink_batch_(const details::log_msg *const *msgs, size_t count) override;
+    void sink_batch_formatted_(const details::log_msg *const *msgs,
+                               size_t count,
+                               const memory_buf_t &formatted,
+                               const size_t *ends) override;
     void flush_() override;
+    void request_flush_() override;
 
 private:
     // Rotate files:
@@ -45,6 +62,18 @@ private:
     // log.2.txt -> log.3.txt
     // log.3.txt -> delete
     void rotate_();
+    // rotate_() on the calling thread
+    void rotate_sync_();
+    // rename the files as above. on failure, set the error and its errno and return false.
+    bool rename_files_(std::size_t max_files, std::string &error, int &error_no);
+
+    // background rotation
+    bool rotate_in_background_();
+    void prepare_next_();
+    void apply_rename_();
+    void housekeeping_loop_();
+    // log.next.txt, then log.next1.txt, log.next2.txt.. after failed renames
+    filename_t calc_next_filename_(std::size_t seq) const;
 
     // delete the target if exists, and rename the src file to target
     // return true on success, false otherwise.
@@ -54,7 +83,29 @@ private:
     std::size_t max_size_;
     std::size_t max_files_;
     std::size_t current_size_;
-    details::file_helper file_helper_;
+    file_options options_;
+    std::unique_ptr<details::file_helper> file_helper_;
+
+    // background rotation. the housekeeping thread opens next_, and after a rotation closes
+    // retired_ and renames the files (then sets renamed_). guarded by hk_mutex_.
+    bool background_ = false;
+    bool next_requested_ = false;  // by the writers, guarded by the sink mutex
+    // name of next_ (housekeeping thread only). changed when the current file keeps it after a
+    // failed rename, so that the next file is never opened (and truncated) over the current one.
+    filename_t next_filename_;
+    std::size_t next_seq_ = 0;
+    std::thread housekeeper_;
+    std::mutex hk_mutex_;
+    std::condition_variable hk_cv_;
+    bool hk_stop_ = false;
+    bool hk_busy_ = false;
+    bool prepare_ = false;
+    bool renamed_ = false;
+    std::unique_ptr<details::file_helper> next_;
+    std::unique_ptr<details::file_helper> retired_;
+    std::size_t retired_max_files_ = 0;
+    std::string hk_error_;
+    int hk_errno_ = 0;
 };
 
 using rotating_file_sink_mt = rotating_file_sink<std::mutex>;
@@ -71,9 +122,9 @@ std::shared_ptr<logger> rotating_logger_mt(const std::string &logger_name,
                                            size_t max_file_size,
                                            size_t max_files,
                                            bool rotate_on_open = false,
-                                           const file_event_handlers &event_handlers = {}) {
+                                           const file_options &options = {}) {
     return Factory::template create<sinks::rotating_file_sink_mt>(
-        logger_name, filename, max_file_size, max_files, rotate_on_open, event_handlers);
+        logger_name, filename, max_file_size, max_files, rotate_on_open, options);
 }
 
 template <typename Factory = spdlog::synchronous_factory>
@@ -82,9 +133,9 @@ std::shared_ptr<logger> rotating_logger_st(const std::string &logger_name,
                                            size_t max_file_size,
                                            size_t max_files,
                                            bool rotate_on_open = false,
-                                           const file_event_handlers &event_handlers = {}) {
+                                           const file_options &options = {}) {
     return Factory::template create<sinks::rotating_file_sink_st>(
-        logger_name, filename, max_file_size, max_files, rotate_on_open, event_handlers);
+        logger_name, filename, max_file_size, max_files, rotate_on_open, options);
 }
 }  // namespace spdlog
 
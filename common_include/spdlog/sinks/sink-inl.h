@@ -9,6 +9,28 @@
 
 #include <spdlog/common.h>
 
+SPDLOG_INLINE void spdlog::sinks::sink::log_batch(const details::log_msg *const *msgs,
+                                                  size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        log(*msgs[i]);
+    }
+}
+
+SPDLOG_INLINE void spdlog::sinks::sink::log_formatted(const details::log_msg &msg,
+                                                      details::shared_format &) {
+    log(msg);
+}
+
+SPDLOG_INLINE void spdlog::sinks::sink::log_batch_formatted(const details::log_msg *const *msgs,
+                                                            size_t count,
+                                                            details::shared_batch_format &) {
+    log_batch(msgs, count);
+}
+
+SPDLOG_INLINE void spdlog::sinks::sink::request_flush() { flush(); }
+
+SPDLOG_INLINE bool spdlog::sinks::sink::needs_payload() { return true; }
+
 SPDLOG_INLINE bool spdlog::sinks::sink::should_log(spdlog::level::level_enum msg_level) const {
     return msg_level >= level_.load(std::memory_order_relaxed);
 }
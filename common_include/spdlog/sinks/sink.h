@@ -4,6 +4,7 @@
 #pragma once
 
 #include <spdlog/details/log_msg.h>
+#include <spdlog/details/shared_format.h>
 #include <spdlog/formatter.h>
 
 namespace spdlog {
@@ -13,7 +14,24 @@ class SPDLOG_API sink {
 public:
     virtual ~sink() = default;
     virtual void log(const details::log_msg &msg) = 0;
+    // log count messages in order. the default implementation calls log() for each of them.
+    virtual void log_batch(const details::log_msg *const *msgs, size_t count);
+    // log msg, writing the formatted output in shared if it was formatted by a sink with the same
+    // format, or filling shared for the next sinks. the default implementation calls log().
+    virtual void log_formatted(const details::log_msg &msg, details::shared_format &shared);
+    // same as log_formatted() for a run of messages. the default implementation calls log_batch().
+    virtual void log_batch_formatted(const details::log_msg *const *msgs,
+                                     size_t count,
+                                     details::shared_batch_format &shared);
     virtual void flush() = 0;
+    // the flush asked for by the logger's flush_on() level or by flush_every(). sinks with a
+    // flush policy may hold it back until the policy is due. the default implementation calls
+    // flush().
+    virtual void request_flush();
+    // whether the sink writes the formatted payload. sinks that write the captured arguments of
+    // deferred messages instead return false, so that async loggers skip formatting them when
+    // none of their sinks needs it. the default implementation returns true.
+    virtual bool needs_payload();
     virtual void set_pattern(const std::string &pattern) = 0;
     virtual void set_formatter(std::unique_ptr<spdlog::formatter> sink_formatter) = 0;
 
@@ -71,12 +71,19 @@ protected:
     void sink_it_(const spdlog::details::log_msg &msg) override {
         spdlog::memory_buf_t formatted;
         spdlog::sinks::base_sink<Mutex>::formatter_->format(msg, formatted);
+        sink_formatted_(msg, formatted);
+    }
+
+    void sink_formatted_(const spdlog::details::log_msg &,
+                         const spdlog::memory_buf_t &formatted) override {
         if (!client_.is_connected()) {
             client_.connect(config_.server_host, config_.server_port, config_.timeout_ms);
         }
         client_.send(formatted.data(), formatted.size());
     }
 
+    bool accepts_formatted_() const override { return true; }
+
     void flush_() override {}
     tcp_sink_config config_;
     details::tcp_client client_;
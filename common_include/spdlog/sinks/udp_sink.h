@@ -45,9 +45,16 @@ protected:
     void sink_it_(const spdlog::details::log_msg &msg) override {
         spdlog::memory_buf_t formatted;
         spdlog::sinks::base_sink<Mutex>::formatter_->format(msg, formatted);
+        sink_formatted_(msg, formatted);
+    }
+
+    void sink_formatted_(const spdlog::details::log_msg &,
+                         const spdlog::memory_buf_t &formatted) override {
         client_.send(formatted.data(), formatted.size());
     }
 
+    bool accepts_formatted_() const override { return true; }
+
     void flush_() override {}
     details::udp_client client_;
 };
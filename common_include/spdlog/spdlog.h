@@ -10,6 +10,7 @@
 #pragma once
 
 #include <spdlog/common.h>
+#include <spdlog/details/call_site.h>
 #include <spdlog/details/registry.h>
 #include <spdlog/details/synchronous_factory.h>
 #include <spdlog/logger.h>
@@ -145,6 +146,29 @@ SPDLOG_API void set_default_logger(std::shared_ptr<spdlog::logger> default_logge
 //   spdlog::apply_logger_env_levels(mylogger);
 SPDLOG_API void apply_logger_env_levels(std::shared_ptr<logger> logger);
 
+// Enable or disable the log macro call sites (SPDLOG_INFO(..) etc.) whose "file:line" or
+// "basename:line" matches the given glob pattern ('*' and '?'), including the call sites that
+// haven't run yet. Returns the number of call sites that have run so far and matched.
+// Example:
+//   spdlog::set_call_sites_enabled("db.cpp:120", false);  // one call site
+//   spdlog::set_call_sites_enabled("*/net/*", false);     // all call sites under net/
+// header only like the call site registry, so it works whether or not spdlog is a compiled lib.
+inline size_t set_call_sites_enabled(const std::string &pattern, bool enabled) {
+    return details::call_site_registry::instance().set_enabled(pattern, enabled);
+}
+
+// Forget the patterns given to set_call_sites_enabled() and enable all call sites
+inline void enable_all_call_sites() { details::call_site_registry::instance().enable_all(); }
+
+// Apply a user-defined function on all the log macro call sites that have run so far
+// Example:
+// spdlog::apply_all_call_sites([&](const spdlog::details::call_site &site) {
+//     if (!site.enabled()) { std::cout << site.basename() << ':' << site.line() << '\n'; }
+// });
+inline void apply_all_call_sites(const std::function<void(const details::call_site &)> &fun) {
+    details::call_site_registry::instance().for_each(fun);
+}
+
 template <typename... Args>
 inline void log(source_loc source,
                 level::level_enum lvl,
@@ -288,9 +312,18 @@ inline void critical(const T &msg) {
 // SPDLOG_LEVEL_OFF
 //
 
+// each call site has a static descriptor (see details/call_site.h) that can be switched off at
+// runtime with set_call_sites_enabled(). the arguments of a disabled call site are not evaluated.
 #ifndef SPDLOG_NO_SOURCE_LOC
     #define SPDLOG_LOGGER_CALL(logger, level, ...) \
-        (logger)->log(spdlog::source_loc{__FILE__, __LINE__, SPDLOG_FUNCTION}, level, __VA_ARGS__)
+        SPDLOG_LOGGER_CALL_AT_(__COUNTER__, #__VA_ARGS__, logger, level, __VA_ARGS__)
+    #define SPDLOG_LOGGER_CALL_AT_(id, args, logger, level, ...)                                 \
+        (spdlog::details::call_site_of<id>(__FILE__, __LINE__, SPDLOG_FUNCTION, args).enabled()  \
+             ? (logger)->log(                                                                    \
+                   spdlog::details::call_site_of<id>(__FILE__, __LINE__, SPDLOG_FUNCTION, args)  \
+                       .loc(),                                                                   \
+                   level, __VA_ARGS__)                                                           \
+             : (void)0)
 #else
     #define SPDLOG_LOGGER_CALL(logger, level, ...) \
         (logger)->log(spdlog::source_loc{}, level, __VA_ARGS__)
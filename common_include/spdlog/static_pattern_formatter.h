@@ -0,0 +1,443 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// Pattern formatter for patterns known at compile time (requires C++17).
+//
+// The pattern is parsed by the compiler. Each flag becomes a member of the concrete flag
+// formatter type (no vector of unique_ptrs, no virtual calls) and the text between flags is
+// appended as precomputed literal runs, so format() is one inlined sequence of appends.
+// Like in pattern_formatter, runs of date/time flags are rendered once per second and cached.
+// The output is the same as pattern_formatter's for the same pattern. Custom flags are not
+// supported.
+//
+// The pattern is passed as a constexpr char array:
+//
+//     static constexpr char my_pattern[] = "[%Y-%m-%d %H:%M:%S.%e] [%l] %v";
+//     logger->set_formatter(
+//         spdlog::details::make_unique<spdlog::static_pattern_formatter<my_pattern>>());
+
+#include <spdlog/details/flag_formatters.h>
+#include <spdlog/formatter.h>
+
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <ctime>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace spdlog {
+namespace details {
+
+// a flag of the pattern, or a run of literal text (flag == '\0')
+struct static_pattern_token {
+    char flag = '\0';
+    size_t begin = 0;  // literal run: offset in the literal buffer
+    size_t size = 0;
+    bool padded = false;
+    size_t width = 0;
+    padding_info::pad_side side = padding_info::pad_side::left;
+    bool truncate = false;
+    size_t run = 0;  // 1 based index of the cached date/time run of the token, 0 if none
+    bool run_start = false;
+};
+
+constexpr bool static_pattern_has(const char *chars, char c) {
+    for (; *chars != '\0'; chars++) {
+        if (*chars == c) {
+            return true;
+        }
+    }
+    return false;
+}
+
+constexpr bool is_static_pattern_flag(char flag) {
+#ifndef SPDLOG_NO_TLS
+    if (flag == '&') {
+        return true;
+    }
+#endif
+    return static_pattern_has("+nlLtvjqKJaAbhBcCYDxmdHIMSefFEprRTXzP^$@sg#!uioO", flag);
+}
+
+constexpr bool static_pattern_needs_localtime(char flag) {
+    return static_pattern_has("+aAbhBcCYDxmdHIMSprRTXz", flag);
+}
+
+// flags that only depend on the time in seconds, see pattern_formatter::kind_of_flag_
+constexpr bool is_static_datetime_flag(char flag) {
+    return flag != '+' && static_pattern_needs_localtime(flag);
+}
+
+// elapsed time flags, see pattern_formatter::is_stateful_flag_
+constexpr bool is_static_stateful_flag(char flag) { return static_pattern_has("uioO", flag); }
+
+// split the pattern into literal chars and flags, the same way pattern_formatter does
+template <typename Sink>
+constexpr void parse_static_pattern(const char *p, Sink &sink) {
+    while (*p != '\0') {
+        if (*p != '%') {
+            sink.literal(*p++);
+            continue;
+        }
+        ++p;
+
+        auto side = padding_info::pad_side::left;
+        if (*p == '-') {
+            side = padding_info::pad_side::right;
+            ++p;
+        } else if (*p == '=') {
+            side = padding_info::pad_side::center;
+            ++p;
+        }
+        bool padded = false;
+        size_t width = 0;
+        bool truncate = false;
+        if (*p >= '0' && *p <= '9') {
+            padded = true;
+            for (; *p >= '0' && *p <= '9'; ++p) {
+                width = width * 10 + static_cast<size_t>(*p - '0');
+            }
+            if (*p == '!') {
+                truncate = true;
+                ++p;
+            }
+            width = width < 64 ? width : 64;
+        }
+
+        if (*p == '\0') {
+            break;
+        }
+        char flag = *p++;
+        if (flag == '%') {
+            sink.literal('%');
+        } else if (is_static_pattern_flag(flag)) {
+            sink.flag(flag, padded, width, side, truncate);
+        } else if (!truncate) {  // unknown flag appears as is
+            sink.literal('%');
+            sink.literal(flag);
+        } else {  // "%3!!" is a truncated funcname, see pattern_formatter::handle_flag_
+            sink.flag('!', padded, width, side, false);
+            sink.literal(flag);
+        }
+    }
+}
+
+// first pass: sizes of the token and literal arrays
+struct static_pattern_counter {
+    size_t tokens = 0;
+    size_t literal_chars = 0;
+    bool need_localtime = false;
+    bool stateful = false;
+    bool in_literal = false;
+
+    constexpr void literal(char) {
+        if (!in_literal) {
+            tokens++;
+            in_literal = true;
+        }
+        literal_chars++;
+    }
+
+    constexpr void flag(char flag, bool, size_t, padding_info::pad_side, bool) {
+        tokens++;
+        in_literal = false;
+        need_localtime = need_localtime || static_pattern_needs_localtime(flag);
+        stateful = stateful || is_static_stateful_flag(flag);
+    }
+};
+
+// second pass: the tokens, with the literal runs copied to one buffer
+template <size_t Tokens, size_t LiteralChars>
+struct static_pattern_parser {
+    std::array<static_pattern_token, Tokens> tokens{};
+    std::array<char, LiteralChars> literals{};
+    size_t token_count = 0;
+    size_t literal_count = 0;
+    bool in_literal = false;
+
+    constexpr void literal(char c) {
+        if (!in_literal) {
+            tokens[token_count].begin = literal_count;
+            token_count++;
+            in_literal = true;
+        }
+        literals[literal_count++] = c;
+        tokens[token_count - 1].size++;
+    }
+
+    constexpr void flag(
+        char flag, bool padded, size_t width, padding_info::pad_side side, bool truncate) {
+        auto &token = tokens[token_count++];
+        token.flag = flag;
+        token.padded = padded;
+        token.width = width;
+        token.side = side;
+        token.truncate = truncate;
+        in_literal = false;
+    }
+
+    // mark the runs of literals and date/time flags that contain at least one date/time flag
+    constexpr void group_datetime_runs() {
+        size_t runs = 0;
+        size_t i = 0;
+        while (i < token_count) {
+            if (tokens[i].flag != '\0' && !is_static_datetime_flag(tokens[i].flag)) {
+                i++;
+                continue;
+            }
+            auto run_end = i;
+            bool has_datetime = false;
+            for (; run_end < token_count && (tokens[run_end].flag == '\0' ||
+                                             is_static_datetime_flag(tokens[run_end].flag));
+                 run_end++) {
+                has_datetime = has_datetime || tokens[run_end].flag != '\0';
+            }
+            if (has_datetime) {
+                runs++;
+                tokens[i].run_start = true;
+                for (auto j = i; j < run_end; j++) {
+                    tokens[j].run = runs;
+                }
+            }
+            i = run_end;
+        }
+    }
+};
+
+constexpr static_pattern_counter count_static_pattern(const char *pattern) {
+    static_pattern_counter counter;
+    parse_static_pattern(pattern, counter);
+    return counter;
+}
+
+template <size_t Tokens, size_t LiteralChars>
+constexpr static_pattern_parser<Tokens, LiteralChars> compile_static_pattern(const char *pattern) {
+    static_pattern_parser<Tokens, LiteralChars> parser;
+    parse_static_pattern(pattern, parser);
+    parser.group_datetime_runs();
+    return parser;
+}
+
+template <const char *Pattern>
+struct static_pattern {
+    static constexpr static_pattern_counter counts = count_static_pattern(Pattern);
+    static constexpr auto compiled =
+        compile_static_pattern<counts.tokens, counts.literal_chars>(Pattern);
+};
+
+inline padding_info static_padding(const static_pattern_token &token) {
+    return token.padded ? padding_info{token.width, token.side, token.truncate} : padding_info{};
+}
+
+// literal run I of the pattern
+template <const char *Pattern, size_t I>
+class static_literal_formatter {
+public:
+    explicit static_literal_formatter(padding_info) {}
+
+    void format(const log_msg &, const std::tm &, memory_buf_t &dest) {
+        constexpr auto &compiled = static_pattern<Pattern>::compiled;
+        fmt_helper::append_string_view(
+            string_view_t{compiled.literals.data() + compiled.tokens[I].begin,
+                          compiled.tokens[I].size},
+            dest);
+    }
+};
+
+// flag formatter type of each flag, as in pattern_formatter::handle_flag_
+template <char Flag, typename Padder>
+struct static_flag;
+
+// clang-format off
+template <typename P> struct static_flag<'+', P> { using type = full_formatter; };
+template <typename P> struct static_flag<'n', P> { using type = name_formatter<P>; };
+template <typename P> struct static_flag<'l', P> { using type = level_formatter<P>; };
+template <typename P> struct static_flag<'L', P> { using type = short_level_formatter<P>; };
+template <typename P> struct static_flag<'t', P> { using type = t_formatter<P>; };
+template <typename P> struct static_flag<'v', P> { using type = v_formatter<P>; };
+template <typename P> struct static_flag<'j', P> { using type = json_formatter; };
+template <typename P> struct static_flag<'q', P> { using type = logfmt_formatter; };
+template <typename P> struct static_flag<'K', P> { using type = fields_formatter; };
+template <typename P> struct static_flag<'J', P> { using type = json_fields_formatter; };
+template <typename P> struct static_flag<'a', P> { using type = a_formatter<P>; };
+template <typename P> struct static_flag<'A', P> { using type = A_formatter<P>; };
+template <typename P> struct static_flag<'b', P> { using type = b_formatter<P>; };
+template <typename P> struct static_flag<'h', P> { using type = b_formatter<P>; };
+template <typename P> struct static_flag<'B', P> { using type = B_formatter<P>; };
+template <typename P> struct static_flag<'c', P> { using type = c_formatter<P>; };
+template <typename P> struct static_flag<'C', P> { using type = C_formatter<P>; };
+template <typename P> struct static_flag<'Y', P> { using type = Y_formatter<P>; };
+template <typename P> struct static_flag<'D', P> { using type = D_formatter<P>; };
+template <typename P> struct static_flag<'x', P> { using type = D_formatter<P>; };
+template <typename P> struct static_flag<'m', P> { using type = m_formatter<P>; };
+template <typename P> struct static_flag<'d', P> { using type = d_formatter<P>; };
+template <typename P> struct static_flag<'H', P> { using type = H_formatter<P>; };
+template <typename P> struct static_flag<'I', P> { using type = I_formatter<P>; };
+template <typename P> struct static_flag<'M', P> { using type = M_formatter<P>; };
+template <typename P> struct static_flag<'S', P> { using type = S_formatter<P>; };
+template <typename P> struct static_flag<'e', P> { using type = e_formatter<P>; };
+template <typename P> struct static_flag<'f', P> { using type = f_formatter<P>; };
+template <typename P> struct static_flag<'F', P> { using type = F_formatter<P>; };
+template <typename P> struct static_flag<'E', P> { using type = E_formatter<P>; };
+template <typename P> struct static_flag<'p', P> { using type = p_formatter<P>; };
+template <typename P> struct static_flag<'r', P> { using type = r_formatter<P>; };
+template <typename P> struct static_flag<'R', P> { using type = R_formatter<P>; };
+template <typename P> struct static_flag<'T', P> { using type = T_formatter<P>; };
+template <typename P> struct static_flag<'X', P> { using type = T_formatter<P>; };
+template <typename P> struct static_flag<'z', P> { using type = z_formatter<P>; };
+template <typename P> struct static_flag<'P', P> { using type = pid_formatter<P>; };
+template <typename P> struct static_flag<'^', P> { using type = color_start_formatter; };
+template <typename P> struct static_flag<'$', P> { using type = color_stop_formatter; };
+template <typename P> struct static_flag<'@', P> { using type = source_location_formatter<P>; };
+template <typename P> struct static_flag<'s', P> { using type = short_filename_formatter<P>; };
+template <typename P> struct static_flag<'g', P> { using type = source_filename_formatter<P>; };
+template <typename P> struct static_flag<'#', P> { using type = source_linenum_formatter<P>; };
+template <typename P> struct static_flag<'!', P> { using type = source_funcname_formatter<P>; };
+template <typename P> struct static_flag<'u', P> { using type = elapsed_formatter<P, std::chrono::nanoseconds>; };
+template <typename P> struct static_flag<'i', P> { using type = elapsed_formatter<P, std::chrono::microseconds>; };
+template <typename P> struct static_flag<'o', P> { using type = elapsed_formatter<P, std::chrono::milliseconds>; };
+template <typename P> struct static_flag<'O', P> { using type = elapsed_formatter<P, std::chrono::seconds>; };
+#ifndef SPDLOG_NO_TLS
+template <typename P> struct static_flag<'&', P> { using type = mdc_formatter<P>; };
+#endif
+// clang-format on
+
+// formatter type of token I
+template <const char *Pattern, size_t I, char Flag = static_pattern<Pattern>::compiled.tokens[I].flag>
+struct static_token {
+    using padder = typename std::conditional<static_pattern<Pattern>::compiled.tokens[I].padded,
+                                             scoped_padder,
+                                             null_scoped_padder>::type;
+    using type = typename static_flag<Flag, padder>::type;
+};
+
+template <const char *Pattern, size_t I>
+struct static_token<Pattern, I, '\0'> {
+    using type = static_literal_formatter<Pattern, I>;
+};
+
+template <const char *Pattern, typename Indices>
+struct static_token_tuple;
+
+template <const char *Pattern, size_t... I>
+struct static_token_tuple<Pattern, std::index_sequence<I...>> {
+    using type = std::tuple<typename static_token<Pattern, I>::type...>;
+};
+
+}  // namespace details
+
+template <const char *Pattern>
+class static_pattern_formatter final : public formatter {
+    using pattern = details::static_pattern<Pattern>;
+    using indices = std::make_index_sequence<pattern::counts.tokens>;
+
+public:
+    explicit static_pattern_formatter(pattern_time_type time_type = pattern_time_type::local,
+                                      std::string eol = spdlog::details::os::default_eol)
+        : static_pattern_formatter(time_type, std::move(eol), indices{}) {}
+
+    static_pattern_formatter(const static_pattern_formatter &other) = delete;
+    static_pattern_formatter &operator=(const static_pattern_formatter &other) = delete;
+
+    std::unique_ptr<formatter> clone() const override {
+        return details::make_unique<static_pattern_formatter>(pattern_time_type_, eol_);
+    }
+
+    void format(const details::log_msg &msg, memory_buf_t &dest) override {
+        if (pattern::counts.need_localtime) {
+            const auto secs =
+                std::chrono::duration_cast<std::chrono::seconds>(msg.time.time_since_epoch());
+            if (secs != last_log_secs_ || !cached_) {
+                cached_tm_ = get_time_(msg);
+                last_log_secs_ = secs;
+                cached_datetime_.clear();
+                render_datetime_(msg, indices{});
+                cached_ = true;
+            }
+        }
+        format_(msg, dest, indices{});
+        details::fmt_helper::append_string_view(eol_, dest);
+    }
+
+    // the elapsed time flags depend on the previous messages, so such patterns are never shared
+    std::string output_key() const override {
+        if (pattern::counts.stateful) {
+            return std::string();
+        }
+        std::string key("static:");
+        key += pattern_time_type_ == pattern_time_type::local ? 'l' : 'u';
+        key += eol_;
+        key += '\0';
+        key += Pattern;
+        return key;
+    }
+
+private:
+    template <size_t... I>
+    static_pattern_formatter(pattern_time_type time_type,
+                             std::string eol,
+                             std::index_sequence<I...>)
+        : eol_(std::move(eol)),
+          pattern_time_type_(time_type),
+          last_log_secs_(0),
+          formatters_(details::static_padding(pattern::compiled.tokens[I])...) {
+        std::memset(&cached_tm_, 0, sizeof(cached_tm_));
+    }
+
+    template <size_t... I>
+    void render_datetime_(const details::log_msg &msg, std::index_sequence<I...>) {
+        (void)msg;
+        (render_datetime_token_<I>(msg), ...);
+    }
+
+    template <size_t I>
+    void render_datetime_token_(const details::log_msg &msg) {
+        constexpr auto &token = pattern::compiled.tokens[I];
+        if constexpr (token.run != 0) {
+            std::get<I>(formatters_).format(msg, cached_tm_, cached_datetime_);
+            run_ends_[token.run] = cached_datetime_.size();
+        }
+    }
+
+    template <size_t... I>
+    void format_(const details::log_msg &msg, memory_buf_t &dest, std::index_sequence<I...>) {
+        (void)msg;
+        (void)dest;
+        (format_token_<I>(msg, dest), ...);
+    }
+
+    template <size_t I>
+    void format_token_(const details::log_msg &msg, memory_buf_t &dest) {
+        constexpr auto &token = pattern::compiled.tokens[I];
+        if constexpr (token.run == 0) {
+            std::get<I>(formatters_).format(msg, cached_tm_, dest);
+        } else if constexpr (token.run_start) {
+            dest.append(cached_datetime_.data() + run_ends_[token.run - 1],
+                        cached_datetime_.data() + run_ends_[token.run]);
+        }
+    }
+
+    std::tm get_time_(const details::log_msg &msg) {
+        if (pattern_time_type_ == pattern_time_type::local) {
+            return details::os::localtime(log_clock::to_time_t(msg.time));
+        }
+        return details::os::gmtime(log_clock::to_time_t(msg.time));
+    }
+
+    std::string eol_;
+    pattern_time_type pattern_time_type_;
+    std::tm cached_tm_;
+    std::chrono::seconds last_log_secs_;
+    typename details::static_token_tuple<Pattern, indices>::type formatters_;
+    bool cached_ = false;
+    memory_buf_t cached_datetime_;
+    std::array<size_t, pattern::counts.tokens + 1> run_ends_{};  // end offsets of the runs
+};
+
+}  // namespace spdlog
@@ -19,6 +19,31 @@
 // #define SPDLOG_CLOCK_COARSE
 ///////////////////////////////////////////////////////////////////////////////
 
+///////////////////////////////////////////////////////////////////////////////
+// Uncomment to use a lock-free ring (per-slot sequence numbers) as the async
+// thread pool queue instead of the mutex/condition-variable based queue.
+// Producers then claim a slot with a single compare-and-swap on the tail and
+// don't take a lock, which scales better with many threads logging to the same
+// async logger.
+//
+// #define SPDLOG_ASYNC_LOCKFREE_QUEUE
+///////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////
+// Uncomment to change the size of the inline payload area of each async queue
+// slot (default 256 bytes). Messages whose logger name and text don't fit are
+// copied into a pooled buffer instead.
+//
+// #define SPDLOG_ASYNC_MSG_INLINE_SIZE 512
+///////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////
+// Uncomment to render the fixed width digit fields (%f, %F) with the scalar
+// code only, even where SSE2 is available.
+//
+// #define SPDLOG_NO_SIMD
+///////////////////////////////////////////////////////////////////////////////
+
 ///////////////////////////////////////////////////////////////////////////////
 // Uncomment if source location logging is not needed.
 // This will prevent spdlog from using __FILE__, __LINE__ and SPDLOG_FUNCTION
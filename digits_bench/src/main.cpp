@@ -0,0 +1,163 @@
+// main.cpp
+// 比较 fmt_helper 当前的定宽数字渲染（write8digits：SSE2 或两位查表的标量版本）
+// 与改动前的实现（逐位 /10，pad6/pad9 先数位数再补 0 后交给 fmt::format_int）：
+//   1. 先用 snprintf 校验当前实现的输出
+//   2. 再分别测 pad2 / pad3 / pad6 / pad9 以及 "%e%f%F" 常见组合 pad3+pad6+pad9 的单次耗时
+//
+// 用法: digits_bench [-n iterations]
+#include <spdlog/details/fmt_helper.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+using bench_clock = std::chrono::steady_clock;
+using spdlog::memory_buf_t;
+namespace fmt_helper = spdlog::details::fmt_helper;
+
+// 改动前 fmt_helper 的实现，作为对照
+namespace legacy {
+static void pad2(int n, memory_buf_t &dest)
+{
+    if (n >= 0 && n < 100) {
+        dest.push_back(static_cast<char>('0' + n / 10));
+        dest.push_back(static_cast<char>('0' + n % 10));
+    } else {
+        fmt_helper::append_int(n, dest);
+    }
+}
+
+static void pad3(std::uint32_t n, memory_buf_t &dest)
+{
+    if (n < 1000) {
+        dest.push_back(static_cast<char>(n / 100 + '0'));
+        n = n % 100;
+        dest.push_back(static_cast<char>((n / 10) + '0'));
+        dest.push_back(static_cast<char>((n % 10) + '0'));
+    } else {
+        fmt_helper::append_int(n, dest);
+    }
+}
+
+static void pad6(std::uint32_t n, memory_buf_t &dest)
+{
+    fmt_helper::pad_uint(n, 6, dest);
+}
+
+static void pad9(std::uint32_t n, memory_buf_t &dest)
+{
+    fmt_helper::pad_uint(n, 9, dest);
+}
+}  // namespace legacy
+
+// 与 snprintf 比较 [0, limit) 内每隔 step 的值，返回出错的个数
+template <typename Pad>
+static size_t check(Pad pad, int width, std::uint32_t limit, std::uint32_t step)
+{
+    size_t errors = 0;
+    memory_buf_t dest;
+    char expected[16];
+    for (std::uint32_t n = 0; n < limit; n += step) {
+        dest.clear();
+        pad(n, dest);
+        auto len = std::snprintf(expected, sizeof(expected), "%0*u", width, n);
+        if (dest.size() != static_cast<size_t>(len) || std::memcmp(dest.data(), expected, dest.size()) != 0) {
+            if (errors++ == 0) {
+                std::printf("mismatch for %u: \"%.*s\" vs \"%s\"\n", n, static_cast<int>(dest.size()), dest.data(),
+                            expected);
+            }
+        }
+    }
+    return errors;
+}
+
+// 单次调用的平均耗时 (ns)。输入取自预先生成的 [0, limit) 伪随机值，避免被常量折叠
+template <typename Pad>
+static double time_pad(Pad pad, std::uint32_t limit, size_t iterations)
+{
+    static const size_t n_values = 4096;
+    std::vector<std::uint32_t> values(n_values);
+    std::uint32_t seed = 12345;
+    for (auto &v : values) {
+        seed = seed * 1103515245u + 12345u;
+        v = seed % limit;
+    }
+
+    memory_buf_t dest;
+    size_t total = 0;
+    auto start = bench_clock::now();
+    for (size_t i = 0; i < iterations; i++) {
+        dest.clear();
+        pad(values[i % n_values], dest);
+        total += static_cast<unsigned char>(dest[dest.size() - 1]);
+    }
+    auto end = bench_clock::now();
+    // 防止循环被优化掉
+    if (total == 42) {
+        std::puts("");
+    }
+    return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()) /
+           static_cast<double>(iterations);
+}
+
+int main(int argc, char *argv[])
+{
+    size_t iterations = 50000000;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            iterations = std::strtoul(argv[++i], nullptr, 10);
+        } else {
+            std::cerr << "usage: digits_bench [-n iterations]" << std::endl;
+            return 2;
+        }
+    }
+    if (iterations == 0) {
+        iterations = 1;
+    }
+
+#ifdef SPDLOG_USE_SSE2
+    std::printf("fmt_helper: sse2\n");
+#else
+    std::printf("fmt_helper: scalar\n");
+#endif
+
+    auto pad2 = [](std::uint32_t n, memory_buf_t &dest) { fmt_helper::pad2(static_cast<int>(n), dest); };
+    auto pad3 = [](std::uint32_t n, memory_buf_t &dest) { fmt_helper::pad3(n, dest); };
+    auto pad6 = [](std::uint32_t n, memory_buf_t &dest) { fmt_helper::pad6(n, dest); };
+    auto pad9 = [](std::uint32_t n, memory_buf_t &dest) { fmt_helper::pad9(n, dest); };
+    auto legacy2 = [](std::uint32_t n, memory_buf_t &dest) { legacy::pad2(static_cast<int>(n), dest); };
+    auto fraction = [](std::uint32_t n, memory_buf_t &dest) {
+        fmt_helper::pad3(n % 1000, dest);
+        fmt_helper::pad6(n % 1000000, dest);
+        fmt_helper::pad9(n, dest);
+    };
+    auto legacy_fraction = [](std::uint32_t n, memory_buf_t &dest) {
+        legacy::pad3(n % 1000, dest);
+        legacy::pad6(n % 1000000, dest);
+        legacy::pad9(n, dest);
+    };
+
+    auto errors = check(pad2, 2, 100, 1) + check(pad3, 3, 1000, 1) + check(pad6, 6, 1000000, 1) +
+                  check(pad9, 9, 1000000000, 331);
+    if (errors != 0) {
+        std::printf("%zu values differ from snprintf\n", errors);
+        return 1;
+    }
+    std::printf("output matches snprintf\n\n");
+
+    std::printf("%-16s %12s %12s\n", "", "legacy (ns)", "current (ns)");
+    std::printf("%-16s %12.2f %12.2f\n", "pad2", time_pad(legacy2, 100, iterations), time_pad(pad2, 100, iterations));
+    std::printf("%-16s %12.2f %12.2f\n", "pad3", time_pad(legacy::pad3, 1000, iterations),
+                time_pad(pad3, 1000, iterations));
+    std::printf("%-16s %12.2f %12.2f\n", "pad6", time_pad(legacy::pad6, 1000000, iterations),
+                time_pad(pad6, 1000000, iterations));
+    std::printf("%-16s %12.2f %12.2f\n", "pad9", time_pad(legacy::pad9, 1000000000, iterations),
+                time_pad(pad9, 1000000000, iterations));
+    std::printf("%-16s %12.2f %12.2f\n", "pad3+pad6+pad9", time_pad(legacy_fraction, 1000000000, iterations),
+                time_pad(fraction, 1000000000, iterations));
+    return 0;
+}
@@ -0,0 +1,159 @@
+// main.cpp
+// 比较 "[%Y-%m-%d %H:%M:%S.%e]" 的两种渲染方式：
+//   1. 逐个 flag 渲染（缓存之前 pattern_formatter 的做法）
+//   2. datetime_cache_formatter：每秒渲染一次整段日期时间，其余消息直接追加缓存的字节
+// 以及完整的 pattern_formatter::format 单条耗时。
+// 消息时间每条前进 1us，即模拟 1M msg/s。
+//
+// 用法: format_bench [-n iterations]
+// pattern_formatter.h 需要在 flag_formatters.h 之前包含（header-only 模式下它会引入 -inl.h）
+#include <spdlog/pattern_formatter.h>
+#include <spdlog/details/flag_formatters.h>
+#include <spdlog/details/os.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+using bench_clock = std::chrono::steady_clock;
+using padder = spdlog::details::null_scoped_padder;
+using flag_list = std::vector<std::unique_ptr<spdlog::details::flag_formatter>>;
+
+// "[%Y-%m-%d %H:%M:%S" 对应的 flag 序列
+static flag_list datetime_flags()
+{
+    using namespace spdlog::details;
+    padding_info pad;
+    flag_list flags;
+    flags.emplace_back(new ch_formatter('['));
+    flags.emplace_back(new Y_formatter<padder>(pad));
+    flags.emplace_back(new ch_formatter('-'));
+    flags.emplace_back(new m_formatter<padder>(pad));
+    flags.emplace_back(new ch_formatter('-'));
+    flags.emplace_back(new d_formatter<padder>(pad));
+    flags.emplace_back(new ch_formatter(' '));
+    flags.emplace_back(new H_formatter<padder>(pad));
+    flags.emplace_back(new ch_formatter(':'));
+    flags.emplace_back(new M_formatter<padder>(pad));
+    flags.emplace_back(new ch_formatter(':'));
+    flags.emplace_back(new S_formatter<padder>(pad));
+    flags.emplace_back(new ch_formatter('.'));
+    return flags;
+}
+
+// 在前缀之后追加 "%e]"，两种方式相同
+static flag_list fraction_flags()
+{
+    using namespace spdlog::details;
+    flag_list flags;
+    flags.emplace_back(new e_formatter<padder>(padding_info{}));
+    flags.emplace_back(new ch_formatter(']'));
+    return flags;
+}
+
+// 按 1M msg/s 的速度格式化 iterations 条消息，返回平均耗时 (ns)。
+// 与 pattern_formatter 一样，std::tm 每秒只计算一次。
+static double time_flags(flag_list &flags, spdlog::log_clock::time_point start_time, size_t iterations,
+                         std::string &last)
+{
+    spdlog::details::log_msg msg("format_bench", spdlog::level::info, "message");
+    std::chrono::seconds tm_secs{-1};
+    std::tm tm_time{};
+    spdlog::memory_buf_t dest;
+
+    auto start = bench_clock::now();
+    for (size_t i = 0; i < iterations; i++) {
+        msg.time = start_time + std::chrono::microseconds(i);
+        auto secs = std::chrono::duration_cast<std::chrono::seconds>(msg.time.time_since_epoch());
+        if (secs != tm_secs) {
+            tm_time = spdlog::details::os::localtime(spdlog::log_clock::to_time_t(msg.time));
+            tm_secs = secs;
+        }
+        dest.clear();
+        for (auto &f : flags) {
+            f->format(msg, tm_time, dest);
+        }
+    }
+    auto end = bench_clock::now();
+    last.assign(dest.data(), dest.size());
+    return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()) /
+           static_cast<double>(iterations);
+}
+
+// 完整 pattern 的单条耗时 (ns)
+static double time_pattern(const std::string &pattern, spdlog::log_clock::time_point start_time, size_t iterations,
+                           std::string &last)
+{
+    spdlog::pattern_formatter formatter(pattern, spdlog::pattern_time_type::local, "");
+    spdlog::details::log_msg msg("format_bench", spdlog::level::info, "message");
+    spdlog::memory_buf_t dest;
+
+    auto start = bench_clock::now();
+    for (size_t i = 0; i < iterations; i++) {
+        msg.time = start_time + std::chrono::microseconds(i);
+        dest.clear();
+        formatter.format(msg, dest);
+    }
+    auto end = bench_clock::now();
+    last.assign(dest.data(), dest.size());
+    return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()) /
+           static_cast<double>(iterations);
+}
+
+int main(int argc, char *argv[])
+{
+    size_t iterations = 10000000;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            iterations = std::strtoul(argv[++i], nullptr, 10);
+        } else {
+            std::cerr << "usage: format_bench [-n iterations]" << std::endl;
+            return 2;
+        }
+    }
+    if (iterations == 0) {
+        iterations = 1;
+    }
+
+    // 1. 逐个 flag
+    auto per_flag = datetime_flags();
+    for (auto &f : fraction_flags()) {
+        per_flag.push_back(std::move(f));
+    }
+
+    // 2. 整段缓存
+    flag_list cached;
+    auto run = std::unique_ptr<spdlog::details::datetime_cache_formatter>(new spdlog::details::datetime_cache_formatter());
+    for (auto &f : datetime_flags()) {
+        run->add(std::move(f));
+    }
+    cached.push_back(std::move(run));
+    for (auto &f : fraction_flags()) {
+        cached.push_back(std::move(f));
+    }
+
+    std::string per_flag_out, cached_out, pattern_out;
+    auto start_time = spdlog::log_clock::now();
+    auto per_flag_ns = time_flags(per_flag, start_time, iterations, per_flag_out);
+    auto cached_ns = time_flags(cached, start_time, iterations, cached_out);
+    // 两种方式的输出必须一致（最后一条消息的时间相同）
+    if (per_flag_out != cached_out) {
+        std::printf("output mismatch: \"%s\" vs \"%s\"\n", per_flag_out.c_str(), cached_out.c_str());
+        return 1;
+    }
+
+    const std::string pattern = "[%Y-%m-%d %H:%M:%S.%e] [%l] %v";
+    auto pattern_ns = time_pattern(pattern, start_time, iterations, pattern_out);
+
+    std::printf("%-32s %10s  %s\n", "", "ns/msg", "last output");
+    std::printf("%-32s %10.1f  %s\n", "per flag [%Y-%m-%d %H:%M:%S.%e]", per_flag_ns, per_flag_out.c_str());
+    std::printf("%-32s %10.1f  %s\n", "cached   [%Y-%m-%d %H:%M:%S.%e]", cached_ns, cached_out.c_str());
+    std::printf("%-32s %10.1f  %s\n", "pattern_formatter::format", pattern_ns, pattern_out.c_str());
+    return 0;
+}
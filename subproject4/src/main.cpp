@@ -42,6 +42,10 @@ bool setupLogging()
         std::string pattern = config->GetString("pattern");
         std::string filename = config->GetString("filename");
         bool immediate_flush = config->GetBool("immediate_flush");
+        bool io_uring = config->GetBoolDefault("io_uring", false);
+        int buffer_kb = config->GetIntDefault("buffer_kb", 0);
+        int flush_interval_ms = config->GetIntDefault("flush_interval_ms", 0);
+        bool background_rotation = config->GetBoolDefault("background_rotation", false);
         
         // 获取滚动策略
         int rotation_strategy = config->GetInt("rotation_strategy");
@@ -54,6 +58,17 @@ bool setupLogging()
         //采用容器存储多个sink————可以同时输出到控制台和文件
         std::vector<spdlog::sink_ptr> sinks;
 
+        // 文件写入方式：io_uring 异步提交写入，刷新时不阻塞在磁盘上（仅 linux，不可用时退回 stdio）
+        spdlog::file_options file_options;
+        file_options.io_uring = io_uring;
+        // 写缓冲区大小，以及刷新策略：积累的数据达到缓冲区的一半或最早的数据超过 flush_interval_ms 时才写盘
+        if (buffer_kb > 0) {
+            file_options.buffer_size = static_cast<size_t>(buffer_kb) * 1024;
+            file_options.flush_bytes = file_options.buffer_size / 2;
+        }
+        file_options.flush_interval = std::chrono::milliseconds(flush_interval_ms);
+        // 按大小滚动时，由后台线程预先打开下一个文件并完成重命名，写日志的线程只需切换文件
+        file_options.background_rotation = background_rotation;
         
         // 控制台sink
         if (log_console) {
@@ -73,7 +88,9 @@ bool setupLogging()
             (
                 filename, 
                 max_size * 1024, 
-                max_files
+                max_files,
+                false,
+                file_options
             );
             file_sink->set_pattern(pattern);
             sinks.push_back(file_sink);
@@ -90,7 +107,10 @@ bool setupLogging()
             (
                 filename,
                 hour, 
-                minute
+                minute,
+                false,
+                0,
+                file_options
             );
             file_sink->set_pattern(pattern);
             sinks.push_back(file_sink);
@@ -105,7 +125,7 @@ bool setupLogging()
         
         // 6. 设置立即刷新（如果需要）
         if (immediate_flush) {
-            logger->flush_on(spdlog::level::trace); // 所有级别都立即刷新
+            logger->flush_on(spdlog::level::trace); // 所有级别都请求刷新，设置了刷新策略时由策略决定是否写盘
         }
         
         // 7. 将创建的日志器设置为全局默认日志器